@@ -32,7 +32,9 @@
 
 #define COPYRIGHT "2025 Davide Mastromatteo"
 
+// the stack starts with room for STACK_LENGTH values and grows on demand
 #define STACK_LENGTH 99
+#define STACK_MAX_LENGTH (1L << 28)
 #define INPUT_BUFFER 100
 #define MAX_VIEWABLE_STACK 15
 #define HISTORY_MAX_VIEWABLE_ELEMENTS 15
@@ -41,15 +43,25 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <stdint.h>
 #include <math.h>
+#include <complex.h>
+#include <float.h>
 #include <time.h>
 #include <getopt.h>
 #include <ctype.h>
 
 #include <termios.h>
 #include <unistd.h>
-
-double stack[STACK_LENGTH];
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <errno.h>
+
+double *stack = NULL;
+// low parts of the stack entries, used in double-double mode
+double *stack_lo = NULL;
+long stack_capacity = 0;
 char operation_log[100][500];
 int n_operation_log = 0;
 int sp = 0;
@@ -59,7 +71,26 @@ int view_offset = 0;
 char mode = 'r';
 char numeric_format = 's';
 
+// dc2 starts computing with floating point numbers
+char arithmetic_mode = 'f';
+
+// dc2 starts using the accurate math functions of libm
+char precision = 'a';
+
+#include "dc2_dd.c"
 #include "dc2_stack.c"
+#include "dc2_bignum.c"
+#include "dc2_fastmath.c"
+#include "dc2_random.c"
+
+int is_lazy(double value);
+int has_lazy_tag(double value);
+int refuse_lazy(char *name, long from);
+void describe_lazy(double value, char *text, int size);
+
+#include "dc2_sort.c"
+#include "dc2_fft.c"
+#include "dc2_poly.c"
 #include "dc2_math.c"
 #include "dc2_ui.c"
 
@@ -67,6 +98,15 @@ operation_0o get_operation_0o(char *operation);
 operation_1o get_operation_1o(char *operation); 
 operation_1o get_trigonometric_operation_1o(char *operation); 
 operation_2o get_operation_2o(char *operation); 
+dd_operation_1o get_dd_operation_1o(operation_1o operation);
+dd_operation_2o get_dd_operation_2o(operation_2o operation);
+void set_input_if_numeric(char* input, double* value, int* is_numeric);
+
+#include "dc2_expr.c"
+#include "dc2_diff.c"
+#include "dc2_jit.c"
+#include "dc2_lazy.c"
+#include "dc2_io.c"
 
 
 /* ------------
@@ -80,9 +120,15 @@ void set_input_if_numeric(char* input, double* value, int* is_numeric ) {
   if (endptr[0] == '\0') *is_numeric = 1; 
 }
 
+/* Check if the input is a plain decimal number that
+   can be parsed with all its digits in double-double mode */
+int is_decimal_input(char* input) {
+  return strspn(input, "0123456789.e+-") == strlen(input);
+}
+
 /* Get a random number between 0 and 1 */
 double get_random_number(void) {
-    return drand48();
+    return random_uniform(&random_generator);
 }
 
 /* Set Mode:
@@ -99,6 +145,21 @@ void set_numeric_format(char input_format) {
   if (input_format == 's' || input_format == 'f') numeric_format = input_format;
 }
 
+/* Set Arithmetic Mode:
+   f = Floating point
+   x = Exact integers
+   d = Double-double */
+void set_arithmetic_mode(char input_mode) {
+  if (input_mode == 'f' || input_mode == 'x' || input_mode == 'd') arithmetic_mode = input_mode;
+}
+
+/* Set Precision:
+   a = Accurate (libm) math functions
+   f = Fast polynomial math functions */
+void set_precision(char input_precision) {
+  if (input_precision == 'a' || input_precision == 'f') precision = input_precision;
+}
+
 void set_rad_mode(void) {
   set_mode('r');
 }
@@ -115,6 +176,26 @@ void set_fix_numeric_format(void) {
   set_numeric_format('f');
 }
 
+void set_float_arithmetic_mode(void) {
+  set_arithmetic_mode('f');
+}
+
+void set_exact_arithmetic_mode(void) {
+  set_arithmetic_mode('x');
+}
+
+void set_dd_arithmetic_mode(void) {
+  set_arithmetic_mode('d');
+}
+
+void set_fast_precision(void) {
+  set_precision('f');
+}
+
+void set_accurate_precision(void) {
+  set_precision('a');
+}
+
 /* Compute the command received */
 int compute(char* command, char* last_command) {
 //  int prevent_last_command_mem = 0;
@@ -123,22 +204,56 @@ int compute(char* command, char* last_command) {
   operation_2o operation_2o = NULL;
   operation_1o operation_1o = NULL;
   operation_0o operation_0o = NULL;
+  dd_operation_2o dd_operation_2o = NULL;
+  dd_operation_1o dd_operation_1o = NULL;
 
   if ((strcmp(command, "quit") == 0) ||
       (strcmp(command, "q") == 0)) return 1;
 
+  if (strncmp(command, "load ", 5) == 0) {
+    compute_load(command + 5);
+    return 0;
+  }
+
+  if (strncmp(command, "save ", 5) == 0) {
+    compute_save(command + 5);
+    return 0;
+  }
+
+  if (strncmp(command, "map ", 4) == 0) {
+    compute_map(command + 4);
+    return 0;
+  }
+
+  if (strncmp(command, "diff ", 5) == 0) {
+    compute_diff(command + 5);
+    return 0;
+  }
+
+  if (strncmp(command, "solve ", 6) == 0) {
+    compute_solve(command + 6);
+    return 0;
+  }
+
+  if (strncmp(command, "minimize ", 9) == 0) {
+    compute_minimize(command + 9);
+    return 0;
+  }
+
   if (strcmp(command, "") == 0) {
     if (sp == 0) return 0;
-    push(pick(sp));
+    push_dd(pick_dd(sp));
     return 0;
   }
 
   if (strcmp(command, "e") == 0) {
-    push(M_E);
+    if (arithmetic_mode == 'd') push_dd(DD_E);
+    else push(M_E);
   }
 
   if (strcmp(command, "pi") == 0) {
-    push(M_PI);
+    if (arithmetic_mode == 'd') push_dd(DD_PI);
+    else push(M_PI);
   }
 
   if ((strcmp(command, "random") == 0) ||
@@ -149,21 +264,33 @@ int compute(char* command, char* last_command) {
   set_input_if_numeric(command, &value, &is_numeric);
 
   if (is_numeric) {
-    push(value);
+    if (arithmetic_mode == 'd' && is_decimal_input(command)) push_dd(dd_from_string(command));
+    else push(value);
   } else {
     strcpy(last_command, command);
   }
 
+  if (compute_lazy_operation(command)) return 0;
+
   if ((operation_2o = get_operation_2o(command))) {
-    compute_operation_2o(operation_2o, command);
+    if (arithmetic_mode == 'd' && (dd_operation_2o = get_dd_operation_2o(operation_2o)))
+      compute_dd_operation_2o(dd_operation_2o, command);
+    else
+      compute_operation_2o(operation_2o, command);
   }
 
   if ((operation_1o = get_operation_1o(command))) {
-    compute_operation_1o(operation_1o, command);
+    if (arithmetic_mode == 'd' && (dd_operation_1o = get_dd_operation_1o(operation_1o)))
+      compute_dd_operation_1o(dd_operation_1o, command);
+    else
+      compute_operation_1o(operation_1o, command);
   }
 
   if ((operation_1o = get_trigonometric_operation_1o(command))) {
-    compute_trigonometric_operation_1o(operation_1o, command);
+    if (arithmetic_mode == 'd' && (dd_operation_1o = get_dd_operation_1o(operation_1o)))
+      compute_dd_trigonometric_operation_1o(dd_operation_1o, command);
+    else
+      compute_trigonometric_operation_1o(operation_1o, command);
   }
 
   if ((operation_0o = get_operation_0o(command))) {
@@ -244,10 +371,11 @@ void get_input(char* input) {
     printf("‣ ");
     power_fgets(input, INPUT_BUFFER - 1);
 
-    // to lower case
-    while (*input) {
-        *input = tolower((unsigned char)*input);
-        input++;
+    // to lower case, but not the file names of load and save
+    for (char* c = input; *c; c++) {
+        *c = tolower((unsigned char)*c);
+        if (c - input == 4 &&
+            (strncmp(input, "load ", 5) == 0 || strncmp(input, "save ", 5) == 0)) break;
     }
 
     input[strcspn(input, "\n")] = '\0';
@@ -260,6 +388,12 @@ void handle_command_line_input(int argc, char* argv[]) {
     {"rad", no_argument, 0, 'r'},
     {"sci", no_argument, 0, 's'},
     {"fix", no_argument, 0, 'f'},
+    {"exact", no_argument, 0, 'x'},
+    {"dd", no_argument, 0, 'D'},
+    {"precision", required_argument, 0, 'p'},
+    {"seed", required_argument, 0, 'S'},
+    {"load", required_argument, 0, 'l'},
+    {"save", required_argument, 0, 'o'},
     {"help", no_argument, 0, 'h'},
     {"version", no_argument, 0, 'V'},
     {0, 0, 0, 0}
@@ -268,12 +402,25 @@ void handle_command_line_input(int argc, char* argv[]) {
   int opt = 0;
   int option_index = 0;
 
-  while ((opt = getopt_long(argc, argv, "drsfV", long_options, &option_index))!=-1) {
+  while ((opt = getopt_long(argc, argv, "drsfxDp:S:l:o:V", long_options, &option_index))!=-1) {
     switch(opt) {
       case 'd': set_mode('d'); break;
       case 'r': set_mode('r'); break;
       case 's': set_numeric_format('s'); break;
       case 'f': set_numeric_format('f'); break;
+      case 'x': set_arithmetic_mode('x'); break;
+      case 'D': set_arithmetic_mode('d'); break;
+      case 'p':
+        if (strcmp(optarg, "fast") == 0) set_precision('f');
+        else if (strcmp(optarg, "accurate") == 0) set_precision('a');
+        else {
+          fprintf(stderr, "dc2: precision must be fast or accurate\n");
+          exit(1);
+        }
+        break;
+      case 'S': random_seed(strtoull(optarg, NULL, 0)); break;
+      case 'l': compute_load(optarg); break;
+      case 'o': save_on_quit = optarg; break;
       case 'h': show_command_line_help(); exit(0);
       case 'V': show_version(); exit(0);
       case '?': exit(1);
@@ -304,6 +451,154 @@ operation_0o get_operation_0o(char* operation) {
     return set_sci_numeric_format;
   }
   
+  if (strcmp(operation, "exact") == 0) {
+    return set_exact_arithmetic_mode;
+  }
+
+  if (strcmp(operation, "float") == 0) {
+    return set_float_arithmetic_mode;
+  }
+
+  if (strcmp(operation, "dd") == 0) {
+    return set_dd_arithmetic_mode;
+  }
+
+  if (strcmp(operation, "fast") == 0) {
+    return set_fast_precision;
+  }
+
+  if (strcmp(operation, "accurate") == 0) {
+    return set_accurate_precision;
+  }
+
+  if (strcmp(operation, "sincos") == 0) {
+    return sincos_operation;
+  }
+
+  if (strcmp(operation, "digits") == 0) {
+    return show_exact_digits;
+  }
+
+  if (strcmp(operation, "rndn") == 0) {
+    return random_numbers_operation;
+  }
+
+  if (strcmp(operation, "rndnorm") == 0) {
+    return random_normal_operation;
+  }
+
+  if (strcmp(operation, "rndexp") == 0) {
+    return random_exponential_operation;
+  }
+
+  if (strcmp(operation, "rndint") == 0) {
+    return random_integer_operation;
+  }
+
+  if (strcmp(operation, "sort") == 0) {
+    return sort_operation;
+  }
+
+  if (strcmp(operation, "rsort") == 0) {
+    return rsort_operation;
+  }
+
+  if (strcmp(operation, "median") == 0) {
+    return median_operation;
+  }
+
+  if (strcmp(operation, "nth") == 0) {
+    return nth_operation;
+  }
+
+  if (strcmp(operation, "percentile") == 0) {
+    return percentile_operation;
+  }
+
+  if (strcmp(operation, "uniq") == 0) {
+    return uniq_operation;
+  }
+
+  if (strcmp(operation, "cumsum") == 0) {
+    return cumsum_operation;
+  }
+
+  if (strcmp(operation, "cumprod") == 0) {
+    return cumprod_operation;
+  }
+
+  if (strcmp(operation, "range") == 0) {
+    return range_operation;
+  }
+
+  if (strcmp(operation, "linspace") == 0) {
+    return linspace_operation;
+  }
+
+  if (strcmp(operation, "geom") == 0) {
+    return geom_operation;
+  }
+
+  if (strcmp(operation, "rndseq") == 0) {
+    return rndseq_operation;
+  }
+
+  if (strcmp(operation, "sumx") == 0) {
+    return sumx_operation;
+  }
+
+  if (strcmp(operation, "prodx") == 0) {
+    return prodx_operation;
+  }
+
+  if (strcmp(operation, "meanx") == 0) {
+    return meanx_operation;
+  }
+
+  if (strcmp(operation, "minx") == 0) {
+    return minx_operation;
+  }
+
+  if (strcmp(operation, "maxx") == 0) {
+    return maxx_operation;
+  }
+
+  if (strcmp(operation, "eval") == 0) {
+    return eval_operation;
+  }
+
+  if (strcmp(operation, "fft") == 0) {
+    return fft_operation;
+  }
+
+  if (strcmp(operation, "ifft") == 0) {
+    return ifft_operation;
+  }
+
+  if (strcmp(operation, "psd") == 0) {
+    return psd_operation;
+  }
+
+  if (strcmp(operation, "conv") == 0) {
+    return conv_operation;
+  }
+
+  if (strcmp(operation, "poly") == 0) {
+    return poly_operation;
+  }
+
+  if (strcmp(operation, "polymap") == 0) {
+    return polymap_operation;
+  }
+
+  if (strcmp(operation, "polyroots") == 0) {
+    return polyroots_operation;
+  }
+
+  if (strcmp(operation, "polyfit") == 0) {
+    return polyfit_operation;
+  }
+
   if (strcmp(operation, "license") == 0) {
       return show_license_message;
   }
@@ -358,18 +653,25 @@ operation_0o get_operation_0o(char* operation) {
    to the command received as input */
 operation_1o get_operation_1o(char *operation) {
   if (strcmp(operation, "!") == 0) {
+    if (arithmetic_mode == 'x') return exact_factorial;
     return factorial;}
 
   if (strcmp(operation, "sqrt") == 0) {
     return sqrt;}
 
   if (strcmp(operation, "log10") == 0) {
+    if (precision == 'f') return fast_log10;
     return log10;}
 
   if ((strcmp(operation, "log") == 0) || 
       (strcmp(operation, "ln") == 0)) {
+    if (precision == 'f') return fast_log;
     return log;}
 
+  if (strcmp(operation, "exp") == 0) {
+    if (precision == 'f') return fast_exp;
+    return exp;}
+
   if ((strcmp(operation, "reciprocal") == 0) ||
       (strcmp(operation, "\\") == 0) ||
       (strcmp(operation, "rec") == 0)) {
@@ -383,12 +685,15 @@ operation_1o get_operation_1o(char *operation) {
    to the command received as input */
 operation_1o get_trigonometric_operation_1o(char *operation) {
   if (strcmp(operation, "sin") == 0) {
+    if (precision == 'f') return fast_sin;
     return sin;}
 
   if (strcmp(operation, "cos") == 0) {
+    if (precision == 'f') return fast_cos;
     return cos;}
 
   if (strcmp(operation, "tan") == 0) {
+    if (precision == 'f') return fast_tan;
     return tan;}
 
   if (strcmp(operation, "asin") == 0) {
@@ -398,6 +703,7 @@ operation_1o get_trigonometric_operation_1o(char *operation) {
     return acos;}
 
   if (strcmp(operation, "atan") == 0) {
+    if (precision == 'f') return fast_atan;
     return atan;}
 
   return NULL;
@@ -422,11 +728,40 @@ operation_2o get_operation_2o(char *operation) {
   if ((strcmp(operation, "power") == 0) ||
       (strcmp(operation, "pow") == 0) ||
       (strcmp(operation, "^") == 0)) {
+    if (arithmetic_mode == 'x') return exact_to_power;
     return to_power;}
 
   return NULL;
 }
 
+/* Get the double-double version of a single operand operation */
+dd_operation_1o get_dd_operation_1o(operation_1o operation) {
+  if (operation == factorial) return dd_factorial;
+  if (operation == sqrt) return dd_sqrt;
+  if (operation == log10 || operation == fast_log10) return dd_log10;
+  if (operation == log || operation == fast_log) return dd_log;
+  if (operation == exp || operation == fast_exp) return dd_exp;
+  if (operation == reciprocal) return dd_reciprocal;
+  if (operation == sin || operation == fast_sin) return dd_sin;
+  if (operation == cos || operation == fast_cos) return dd_cos;
+  if (operation == tan || operation == fast_tan) return dd_tan;
+  if (operation == asin) return dd_asin;
+  if (operation == acos) return dd_acos;
+  if (operation == atan || operation == fast_atan) return dd_atan;
+
+  return NULL;
+}
+
+/* Get the double-double version of a two-operands operation */
+dd_operation_2o get_dd_operation_2o(operation_2o operation) {
+  if (operation == sum) return dd_sum;
+  if (operation == subtraction) return dd_subtraction;
+  if (operation == multiplication) return dd_multiplication;
+  if (operation == division) return dd_division;
+  if (operation == to_power) return dd_power;
+
+  return NULL;
+}
 
 /* Entry point */
 int main(int argc, char* argv[]) {
@@ -435,7 +770,9 @@ int main(int argc, char* argv[]) {
 
   /* randomize the seed 
      of the random number generator*/
-  srand48(time(NULL));
+  random_seed(time(NULL));
+
+  reserve_stack(STACK_LENGTH);
 
   handle_command_line_input(argc, argv);
 
@@ -446,5 +783,10 @@ int main(int argc, char* argv[]) {
     if (compute(input, last_input)) break;
   }
 
+  if (save_on_quit && !compute_save(save_on_quit)) {
+    fprintf(stderr, "dc2: %s\n", operation_log[n_operation_log - 1]);
+    return 1;
+  }
+
   return 0;
 }
@@ -0,0 +1,372 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/* dc2.c -- Dave's (RPN) Calculator
+ *
+ * A simple RPN calculator for terminal
+ * made with love in Italy.
+ *
+ * Copyright 2025 Davide Mastromatteo
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation version 2 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+/* ----------------------
+   ARBITRARY PRECISION INTEGERS
+   ---------------------- */
+
+/* Limbs are stored in base 10^9, least significant first, so that
+   printing the decimal digits is just a matter of formatting each limb */
+#define BIGNUM_BASE 1000000000u
+#define BIGNUM_BASE_DIGITS 9
+
+/* Below this many limbs schoolbook multiplication beats Karatsuba.
+   Measured on x86-64 with gcc -O2 multiplying random balanced
+   operands: 32 is slower from 64 limbs up, 64 to 192 are within
+   noise of 48 up to 128 limbs and slower above */
+#define KARATSUBA_THRESHOLD 48
+
+/* Refuse exact results longer than this, they would take too long */
+#define EXACT_MAX_DIGITS 5000000
+
+typedef struct {
+  uint32_t *limb;
+  size_t len;
+  int negative;
+} bignum;
+
+/* The last exact result computed, shown by the "digits" command */
+bignum last_exact = { NULL, 0, 0 };
+
+/* Free the memory used by a big number */
+void bignum_free(bignum *a) {
+  free(a->limb);
+  a->limb = NULL;
+  a->len = 0;
+  a->negative = 0;
+}
+
+/* Allocate len limbs, all set to zero */
+uint32_t *limbs_alloc(size_t len) {
+  uint32_t *a = calloc(len ? len : 1, sizeof(uint32_t));
+  if (a == NULL) {
+    printf("Out Of Memory\n");
+    exit(1);
+  }
+  return a;
+}
+
+/* Allocate a big number with room for len limbs, all set to zero */
+bignum bignum_alloc(size_t len) {
+  bignum a;
+  a.limb = limbs_alloc(len);
+  a.len = len;
+  a.negative = 0;
+  return a;
+}
+
+/* Drop the most significant zero limbs of a number */
+size_t limbs_normalize(const uint32_t *a, size_t n) {
+  while (n > 0 && a[n - 1] == 0) n--;
+  return n;
+}
+
+/* Build a big number from an unsigned integer */
+bignum bignum_from_u64(uint64_t value) {
+  bignum a = bignum_alloc(3);
+  for (size_t i = 0; i < 3; i++) {
+    a.limb[i] = (uint32_t)(value % BIGNUM_BASE);
+    value /= BIGNUM_BASE;
+  }
+  a.len = limbs_normalize(a.limb, 3);
+  return a;
+}
+
+/* r = a + b, r must have room for max(na, nb) + 1 limbs.
+   Returns the length of the result */
+size_t limbs_add(uint32_t *r, const uint32_t *a, size_t na,
+                 const uint32_t *b, size_t nb) {
+  if (na < nb) {
+    const uint32_t *t = a; a = b; b = t;
+    size_t tn = na; na = nb; nb = tn;
+  }
+
+  uint32_t carry = 0;
+  for (size_t i = 0; i < na; i++) {
+    uint32_t s = a[i] + carry + (i < nb ? b[i] : 0);
+    carry = s >= BIGNUM_BASE;
+    r[i] = carry ? s - BIGNUM_BASE : s;
+  }
+  r[na] = carry;
+  return na + 1;
+}
+
+/* r += a, r must be long enough to absorb the final carry */
+void limbs_add_inplace(uint32_t *r, const uint32_t *a, size_t na) {
+  uint32_t carry = 0;
+  size_t i;
+  for (i = 0; i < na; i++) {
+    uint32_t s = r[i] + a[i] + carry;
+    carry = s >= BIGNUM_BASE;
+    r[i] = carry ? s - BIGNUM_BASE : s;
+  }
+  for (; carry; i++) {
+    uint32_t s = r[i] + 1;
+    carry = s >= BIGNUM_BASE;
+    r[i] = carry ? 0 : s;
+  }
+}
+
+/* r -= a, the caller guarantees that r >= a */
+void limbs_sub_inplace(uint32_t *r, const uint32_t *a, size_t na) {
+  uint32_t borrow = 0;
+  size_t i;
+  for (i = 0; i < na; i++) {
+    uint32_t s = a[i] + borrow;
+    borrow = r[i] < s;
+    r[i] = borrow ? r[i] + BIGNUM_BASE - s : r[i] - s;
+  }
+  for (; borrow; i++) {
+    borrow = r[i] == 0;
+    r[i] = borrow ? BIGNUM_BASE - 1 : r[i] - 1;
+  }
+}
+
+/* Products of two limbs are below 10^18, so up to this many of them
+   can be summed in a 64 bit accumulator before propagating carries */
+#define SCHOOLBOOK_ROWS_PER_CARRY 16
+
+/* Propagate the carries of an array of 64 bit accumulators */
+void limbs_carry(uint64_t *acc, size_t n) {
+  uint64_t carry = 0;
+  for (size_t k = 0; k < n; k++) {
+    uint64_t t = acc[k] + carry;
+    carry = t / BIGNUM_BASE;
+    acc[k] = t - carry * BIGNUM_BASE;
+  }
+}
+
+/* r += a * b with the quadratic algorithm, r has room for na + nb limbs.
+   The inner loop runs along the longer operand without any division,
+   carries are propagated once every few rows */
+void limbs_mul_schoolbook(uint32_t *r, const uint32_t *a, size_t na,
+                          const uint32_t *b, size_t nb) {
+  size_t n = na + nb;
+  uint64_t *acc = malloc(n * sizeof(uint64_t));
+  if (acc == NULL) {
+    printf("Out Of Memory\n");
+    exit(1);
+  }
+  for (size_t k = 0; k < n; k++) acc[k] = r[k];
+
+  for (size_t j = 0; j < nb; j++) {
+    uint64_t bj = b[j];
+    uint64_t *row = acc + j;
+    for (size_t i = 0; i < na; i++) row[i] += a[i] * bj;
+    if ((j + 1) % SCHOOLBOOK_ROWS_PER_CARRY == 0) limbs_carry(acc, n);
+  }
+
+  limbs_carry(acc, n);
+  for (size_t k = 0; k < n; k++) r[k] = (uint32_t)acc[k];
+  free(acc);
+}
+
+/* r += a * b, r has room for na + nb limbs.
+   Balanced operands are split in halves and multiplied with
+   Karatsuba's three products; unbalanced operands are cut in
+   slices as long as the shorter one */
+void limbs_mul(uint32_t *r, const uint32_t *a, size_t na,
+               const uint32_t *b, size_t nb) {
+  if (na < nb) {
+    const uint32_t *t = a; a = b; b = t;
+    size_t tn = na; na = nb; nb = tn;
+  }
+
+  if (nb < KARATSUBA_THRESHOLD) {
+    limbs_mul_schoolbook(r, a, na, b, nb);
+    return;
+  }
+
+  if (2 * nb <= na) {
+    for (size_t i = 0; i < na; i += nb) {
+      size_t n = (na - i < nb) ? na - i : nb;
+      limbs_mul(r + i, a + i, n, b, nb);
+    }
+    return;
+  }
+
+  size_t half = na / 2;
+  const uint32_t *a0 = a, *a1 = a + half;
+  const uint32_t *b0 = b, *b1 = b + half;
+  size_t na0 = limbs_normalize(a0, half), na1 = na - half;
+  size_t nb0 = limbs_normalize(b0, half), nb1 = nb - half;
+
+  /* z0 = a0 * b0, z2 = a1 * b1 */
+  uint32_t *z0 = limbs_alloc(2 * half + 1);
+  uint32_t *z2 = limbs_alloc(na1 + nb1 + 1);
+  limbs_mul(z0, a0, na0, b0, nb0);
+  limbs_mul(z2, a1, na1, b1, nb1);
+
+  /* z1 = (a0 + a1) * (b0 + b1) - z0 - z2 */
+  uint32_t *sa = limbs_alloc(na1 + 2);
+  uint32_t *sb = limbs_alloc(na1 + 2);
+  size_t nsa = limbs_normalize(sa, limbs_add(sa, a0, na0, a1, na1));
+  size_t nsb = limbs_normalize(sb, limbs_add(sb, b0, nb0, b1, nb1));
+  size_t nz1 = nsa + nsb + 1;
+  uint32_t *z1 = limbs_alloc(nz1);
+  limbs_mul(z1, sa, nsa, sb, nsb);
+  size_t nz0 = limbs_normalize(z0, na0 + nb0);
+  size_t nz2 = limbs_normalize(z2, na1 + nb1);
+  limbs_sub_inplace(z1, z0, nz0);
+  limbs_sub_inplace(z1, z2, nz2);
+  nz1 = limbs_normalize(z1, nz1);
+
+  limbs_add_inplace(r, z0, nz0);
+  limbs_add_inplace(r + half, z1, nz1);
+  limbs_add_inplace(r + 2 * half, z2, nz2);
+
+  free(z0);
+  free(z1);
+  free(z2);
+  free(sa);
+  free(sb);
+}
+
+/* Multiply two big numbers returning a new one */
+bignum bignum_mul(const bignum *a, const bignum *b) {
+  bignum r = bignum_alloc(a->len + b->len);
+  limbs_mul(r.limb, a->limb, a->len, b->limb, b->len);
+  r.len = limbs_normalize(r.limb, r.len);
+  r.negative = a->negative != b->negative;
+  return r;
+}
+
+/* Multiply the product of all the integers in [lo, hi) by splitting
+   the range in two halves, so that the big multiplications at the top
+   of the tree work on operands of the same size */
+bignum bignum_range_product(uint64_t lo, uint64_t hi) {
+  if (hi - lo <= 16) {
+    bignum r = bignum_from_u64(1);
+    uint64_t small = 1;
+    for (uint64_t i = lo; i < hi; i++) {
+      if (small > UINT64_MAX / i) {
+        bignum s = bignum_from_u64(small);
+        bignum t = bignum_mul(&r, &s);
+        bignum_free(&r);
+        bignum_free(&s);
+        r = t;
+        small = 1;
+      }
+      small *= i;
+    }
+    bignum s = bignum_from_u64(small);
+    bignum t = bignum_mul(&r, &s);
+    bignum_free(&r);
+    bignum_free(&s);
+    return t;
+  }
+
+  uint64_t mid = lo + (hi - lo) / 2;
+  bignum left = bignum_range_product(lo, mid);
+  bignum right = bignum_range_product(mid, hi);
+  bignum r = bignum_mul(&left, &right);
+  bignum_free(&left);
+  bignum_free(&right);
+  return r;
+}
+
+/* Compute n! exactly */
+bignum bignum_factorial(uint64_t n) {
+  if (n < 2) return bignum_from_u64(1);
+  return bignum_range_product(2, n + 1);
+}
+
+/* Compute base^exponent exactly by square-and-multiply */
+bignum bignum_power(const bignum *base, uint64_t exponent) {
+  bignum r = bignum_from_u64(1);
+  bignum b = bignum_alloc(base->len);
+  memcpy(b.limb, base->limb, base->len * sizeof(uint32_t));
+  b.negative = base->negative;
+
+  while (exponent) {
+    if (exponent & 1) {
+      bignum t = bignum_mul(&r, &b);
+      bignum_free(&r);
+      r = t;
+    }
+    exponent >>= 1;
+    if (exponent) {
+      bignum t = bignum_mul(&b, &b);
+      bignum_free(&b);
+      b = t;
+    }
+  }
+
+  bignum_free(&b);
+  return r;
+}
+
+/* Number of decimal digits of a big number */
+size_t bignum_digits(const bignum *a) {
+  if (a->len == 0) return 1;
+  size_t digits = (a->len - 1) * BIGNUM_BASE_DIGITS;
+  for (uint32_t top = a->limb[a->len - 1]; top; top /= 10) digits++;
+  return digits;
+}
+
+/* Convert a big number to the nearest double (inf if it does not fit) */
+double bignum_to_double(const bignum *a) {
+  char buffer[64];
+  int n = 0;
+
+  if (a->len == 0) return 0;
+
+  /* the three most significant limbs hold more digits than a double */
+  n += sprintf(buffer, "%s%u", a->negative ? "-" : "", a->limb[a->len - 1]);
+  size_t used = 1;
+  for (; used < 3 && used < a->len; used++) {
+    n += sprintf(buffer + n, "%09u", a->limb[a->len - 1 - used]);
+  }
+  sprintf(buffer + n, "e%zu", (a->len - used) * BIGNUM_BASE_DIGITS);
+
+  return strtod(buffer, NULL);
+}
+
+/* Print all the digits of a big number */
+void bignum_print(const bignum *a) {
+  if (a->len == 0) {
+    printf("0");
+    return;
+  }
+  printf("%s%u", a->negative ? "-" : "", a->limb[a->len - 1]);
+  for (size_t i = a->len - 1; i > 0; i--) printf("%09u", a->limb[i - 1]);
+}
+
+/* Store the last exact result, releasing the previous one */
+void set_last_exact(bignum *a) {
+  bignum_free(&last_exact);
+  last_exact = *a;
+}
+
+/* Shows all the digits of the last exact result */
+void show_exact_digits(void) {
+  printf("\x1B[1;1H\x1B[2J");
+  if (last_exact.limb == NULL) {
+    printf("No exact result computed yet, switch to exact mode first\n");
+  } else {
+    printf("Last exact result (%zu digits):\n\n", bignum_digits(&last_exact));
+    bignum_print(&last_exact);
+    printf("\n");
+  }
+  printf("\npress ENTER to continue\n");
+  getchar();
+}
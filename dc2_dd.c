@@ -0,0 +1,436 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/* dc2.c -- Dave's (RPN) Calculator
+ *
+ * A simple RPN calculator for terminal
+ * made with love in Italy.
+ *
+ * Copyright 2025 Davide Mastromatteo
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation version 2 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+/* -----------------------
+   DOUBLE-DOUBLE ARITHMETIC
+   ----------------------- */
+
+/* A double-double is the unevaluated sum hi + lo with |lo| <= ulp(hi)/2,
+   giving about 106 bits (31 decimal digits) of precision */
+typedef struct {
+  double hi;
+  double lo;
+} dd;
+
+#define DD_DIGITS 31
+
+const dd DD_PI = { 3.141592653589793, 1.2246467991473532e-16 };
+const dd DD_E = { 2.718281828459045, 1.4456468917292502e-16 };
+const dd DD_LN2 = { 0.6931471805599453, 2.3190468138462996e-17 };
+const dd DD_LN10 = { 2.302585092994046, -2.1707562233822494e-16 };
+const dd DD_PI_2 = { 1.5707963267948966, 6.123233995736766e-17 };
+const dd DD_2PI = { 6.283185307179586, 2.4492935982947064e-16 };
+const dd DD_PI_180 = { 0.017453292519943295, 2.9486522708701687e-19 };
+const dd DD_1E300 = { 1e300, -5.250476025520442e283 };
+
+/* Generic function pointers for the double-double operations */
+typedef dd (*dd_operation_1o)(dd);
+typedef dd (*dd_operation_2o)(dd, dd);
+
+dd dd_from_double(double x) {
+  dd r = { x, 0 };
+  return r;
+}
+
+/* s + e = a + b exactly, assuming |a| >= |b|. Infinities and NaNs
+   get a zero error, as inf - inf would make the error a NaN */
+dd quick_two_sum(double a, double b) {
+  dd r;
+  r.hi = a + b;
+  r.lo = isfinite(r.hi) ? b - (r.hi - a) : 0;
+  return r;
+}
+
+/* s + e = a + b exactly */
+dd two_sum(double a, double b) {
+  dd r;
+  r.hi = a + b;
+  if (!isfinite(r.hi)) {
+    r.lo = 0;
+    return r;
+  }
+  double bb = r.hi - a;
+  r.lo = (a - (r.hi - bb)) + (b - bb);
+  return r;
+}
+
+/* p + e = a * b exactly. The error is computed by fma(), a single
+   instruction where the machine has an FMA (the C library picks it at
+   run time even when the compiler cannot assume it). Dekker's
+   splitting would overflow for |a| or |b| above about 1e300 */
+dd two_prod(double a, double b) {
+  dd r;
+  r.hi = a * b;
+  r.lo = isfinite(r.hi) ? fma(a, b, -r.hi) : 0;
+  return r;
+}
+
+dd dd_add(dd a, dd b) {
+  dd s = two_sum(a.hi, b.hi);
+  dd t = two_sum(a.lo, b.lo);
+  s.lo += t.hi;
+  s = quick_two_sum(s.hi, s.lo);
+  s.lo += t.lo;
+  return quick_two_sum(s.hi, s.lo);
+}
+
+dd dd_neg(dd a) {
+  dd r = { -a.hi, -a.lo };
+  return r;
+}
+
+dd dd_sub(dd a, dd b) {
+  return dd_add(a, dd_neg(b));
+}
+
+dd dd_mul(dd a, dd b) {
+  dd p = two_prod(a.hi, b.hi);
+  /* the cross terms of an overflowed product can overflow too */
+  if (!isfinite(p.hi)) return p;
+  p.lo += a.hi * b.lo + a.lo * b.hi;
+  return quick_two_sum(p.hi, p.lo);
+}
+
+dd dd_mul_double(dd a, double b) {
+  dd p = two_prod(a.hi, b);
+  if (!isfinite(p.hi)) return p;
+  p.lo += a.lo * b;
+  return quick_two_sum(p.hi, p.lo);
+}
+
+dd dd_div(dd a, dd b) {
+  double q1 = a.hi / b.hi;
+  /* zero, infinite and NaN quotients are exact in double */
+  if (q1 == 0 || !isfinite(q1)) return dd_from_double(q1);
+  dd r = dd_sub(a, dd_mul_double(b, q1));
+  double q2 = r.hi / b.hi;
+  r = dd_sub(r, dd_mul_double(b, q2));
+  double q3 = r.hi / b.hi;
+  dd q = quick_two_sum(q1, q2);
+  return dd_add(q, dd_from_double(q3));
+}
+
+dd dd_ldexp(dd a, int e) {
+  dd r = { ldexp(a.hi, e), ldexp(a.lo, e) };
+  return r;
+}
+
+dd dd_sqrt(dd a) {
+  if (a.hi <= 0 || !isfinite(a.hi)) return dd_from_double(sqrt(a.hi));
+  /* the error of ax^2 would fall in the subnormals */
+  if (a.hi < 0x1p-900) return dd_ldexp(dd_sqrt(dd_ldexp(a, 1000)), -500);
+  /* one Newton step on top of the double precision square root */
+  double x = 1.0 / sqrt(a.hi);
+  double ax = a.hi * x;
+  dd ax2 = two_prod(ax, ax);
+  double correction = dd_sub(a, ax2).hi * (x * 0.5);
+  return two_sum(ax, correction);
+}
+
+/* exp is reduced as x = m ln2 + r with |r| <= ln2/2, r is scaled
+   down by 2^9 so that a short Taylor series converges, then the
+   result is squared back up */
+dd dd_exp(dd a) {
+  if (isnan(a.hi)) return a;
+  if (a.hi > 709.78) return dd_from_double(INFINITY);
+  if (a.hi < -745.2) return dd_from_double(0);
+
+  double m = floor(a.hi / DD_LN2.hi + 0.5);
+  dd r = dd_ldexp(dd_sub(a, dd_mul_double(DD_LN2, m)), -9);
+
+  /* s = exp(r) - 1 */
+  dd s = r;
+  dd term = r;
+  for (int n = 2; n < 20; n++) {
+    term = dd_mul(term, dd_div(r, dd_from_double(n)));
+    s = dd_add(s, term);
+    if (fabs(term.hi) < 1e-33 * fabs(s.hi)) break;
+  }
+
+  /* (1 + s)^2 - 1 = 2s + s^2 */
+  for (int i = 0; i < 9; i++) s = dd_add(dd_ldexp(s, 1), dd_mul(s, s));
+
+  return dd_ldexp(dd_add(s, dd_from_double(1)), (int)m);
+}
+
+/* log is computed with one Newton step x' = x + a exp(-x) - 1
+   starting from the double precision logarithm */
+dd dd_log(dd a) {
+  if (a.hi <= 0 || !isfinite(a.hi)) return dd_from_double(log(a.hi));
+  if (a.hi == 1 && a.lo == 0) return dd_from_double(0);
+
+  /* far from 1 take out the binary exponent, as exp(-x) would
+     overflow or lose digits in the subnormals */
+  if (a.hi < 0x1p-500 || a.hi > 0x1p500) {
+    int k = ilogb(a.hi);
+    return dd_add(dd_log(dd_ldexp(a, -k)), dd_mul_double(DD_LN2, k));
+  }
+
+  dd x = dd_from_double(log(a.hi));
+  dd t = dd_mul(a, dd_exp(dd_neg(x)));
+  return dd_sub(dd_add(x, t), dd_from_double(1));
+}
+
+dd dd_log10(dd a) {
+  return dd_div(dd_log(a), DD_LN10);
+}
+
+/* Taylor series of sin and cos for |x| <= pi/4 */
+dd dd_sin_taylor(dd x) {
+  dd x2 = dd_neg(dd_mul(x, x));
+  dd s = x;
+  dd term = x;
+  for (int n = 2; n < 40; n += 2) {
+    term = dd_div(dd_mul(term, x2), dd_from_double(n * (n + 1)));
+    s = dd_add(s, term);
+    if (fabs(term.hi) < 1e-33 * fabs(s.hi)) break;
+  }
+  return s;
+}
+
+dd dd_cos_taylor(dd x) {
+  dd x2 = dd_neg(dd_mul(x, x));
+  dd s = dd_from_double(1);
+  dd term = s;
+  for (int n = 1; n < 40; n += 2) {
+    term = dd_div(dd_mul(term, x2), dd_from_double(n * (n + 1)));
+    s = dd_add(s, term);
+    if (fabs(term.hi) < 1e-33) break;
+  }
+  return s;
+}
+
+/* Reduce x to r in [-pi/4, pi/4] and return the quadrant of x */
+int dd_reduce_quadrant(dd x, dd *r) {
+  dd k = dd_from_double(floor(x.hi / DD_2PI.hi + 0.5));
+  dd t = dd_sub(x, dd_mul(DD_2PI, k));
+  double j = floor(t.hi / DD_PI_2.hi + 0.5);
+  *r = dd_sub(t, dd_mul_double(DD_PI_2, j));
+  return ((int)j + 4) % 4;
+}
+
+dd dd_sin(dd a) {
+  dd r;
+  switch (dd_reduce_quadrant(a, &r)) {
+  case 0: return dd_sin_taylor(r);
+  case 1: return dd_cos_taylor(r);
+  case 2: return dd_neg(dd_sin_taylor(r));
+  default: return dd_neg(dd_cos_taylor(r));
+  }
+}
+
+dd dd_cos(dd a) {
+  dd r;
+  switch (dd_reduce_quadrant(a, &r)) {
+  case 0: return dd_cos_taylor(r);
+  case 1: return dd_neg(dd_sin_taylor(r));
+  case 2: return dd_neg(dd_cos_taylor(r));
+  default: return dd_sin_taylor(r);
+  }
+}
+
+dd dd_tan(dd a) {
+  return dd_div(dd_sin(a), dd_cos(a));
+}
+
+/* atan refines the double precision result z with
+   tan(d) = (a cos z - sin z) / (cos z + a sin z), d ~ tan(d) */
+dd dd_atan(dd a) {
+  dd z = dd_from_double(atan(a.hi));
+  dd s = dd_sin(z);
+  dd c = dd_cos(z);
+  dd d = dd_div(dd_sub(dd_mul(a, c), s), dd_add(c, dd_mul(a, s)));
+  return dd_add(z, d);
+}
+
+dd dd_asin(dd a) {
+  dd one = dd_from_double(1);
+  if (fabs(a.hi) >= 1) return dd_from_double(asin(a.hi));
+  dd root = dd_sqrt(dd_mul(dd_sub(one, a), dd_add(one, a)));
+  return dd_atan(dd_div(a, root));
+}
+
+dd dd_acos(dd a) {
+  dd one = dd_from_double(1);
+  if (fabs(a.hi) >= 1) return dd_from_double(acos(a.hi));
+  dd t = dd_sqrt(dd_div(dd_sub(one, a), dd_add(one, a)));
+  return dd_ldexp(dd_atan(t), 1);
+}
+
+dd dd_reciprocal(dd a) {
+  return dd_div(dd_from_double(1), a);
+}
+
+/* Integer powers by square-and-multiply, anything else as exp(x log y) */
+dd dd_power(dd x, dd y) {
+  if (x.lo == 0 && x.hi == floor(x.hi) && fabs(x.hi) < 2147483648.0) {
+    long n = (long)fabs(x.hi);
+    dd r = dd_from_double(1);
+    dd b = y;
+    while (n) {
+      if (n & 1) r = dd_mul(r, b);
+      n >>= 1;
+      if (n) b = dd_mul(b, b);
+    }
+    return x.hi < 0 ? dd_reciprocal(r) : r;
+  }
+  /* zero or negative bases and non-finite operands have no logarithm
+     to go through, their powers are those of double */
+  if (y.hi <= 0 || !isfinite(y.hi) || !isfinite(x.hi)) return dd_from_double(pow(y.hi, x.hi));
+  return dd_exp(dd_mul(x, dd_log(y)));
+}
+
+dd dd_factorial(dd a) {
+  if (a.lo != 0 || a.hi != floor(a.hi) || a.hi < 0 || a.hi > 170) {
+    return dd_from_double(tgamma(a.hi + 1));
+  }
+  dd r = dd_from_double(1);
+  for (int i = 2; i <= (int)a.hi; i++) r = dd_mul_double(r, i);
+  return r;
+}
+
+/* The operands follow the convention of dc2_math.c:
+   x is the top of the stack, y the one below */
+dd dd_sum(dd x, dd y) {
+  return dd_add(y, x);
+}
+
+dd dd_subtraction(dd x, dd y) {
+  return dd_sub(y, x);
+}
+
+dd dd_multiplication(dd x, dd y) {
+  return dd_mul(x, y);
+}
+
+dd dd_division(dd x, dd y) {
+  return dd_div(y, x);
+}
+
+/* a * 10^e, with powers of ten of at most 10^300 so that they stay
+   finite. The steps towards 1 come first, a result in the subnormals
+   is only reached by the last one */
+dd dd_scale10(dd a, int e) {
+  const dd ten = dd_from_double(10);
+
+  for (; e > 300; e -= 300) a = dd_mul(a, DD_1E300);
+  for (; e < -300; e += 300) a = dd_div(a, DD_1E300);
+  if (e > 0) a = dd_mul(a, dd_power(dd_from_double(e), ten));
+  if (e < 0) a = dd_div(a, dd_power(dd_from_double(-e), ten));
+  return a;
+}
+
+/* Parse a decimal number keeping all its digits */
+dd dd_from_string(const char *s) {
+  dd r = dd_from_double(0);
+  int negative = 0;
+  int exponent = 0;
+
+  if (*s == '-' || *s == '+') negative = (*s++ == '-');
+
+  for (; isdigit((unsigned char)*s); s++) {
+    r = dd_add(dd_mul_double(r, 10), dd_from_double(*s - '0'));
+  }
+  if (*s == '.') {
+    for (s++; isdigit((unsigned char)*s); s++) {
+      r = dd_add(dd_mul_double(r, 10), dd_from_double(*s - '0'));
+      exponent--;
+    }
+  }
+  if (*s == 'e' || *s == 'E') exponent += atoi(s + 1);
+
+  r = dd_scale10(r, exponent);
+
+  return negative ? dd_neg(r) : r;
+}
+
+/* Format a double-double with the given number of significant digits,
+   in positional notation for moderate magnitudes like %g does */
+void dd_to_string(char *buffer, dd a, int digits) {
+  if (isnan(a.hi) || isinf(a.hi)) {
+    sprintf(buffer, "%g", a.hi);
+    return;
+  }
+  if (a.hi == 0) {
+    strcpy(buffer, "0");
+    return;
+  }
+
+  char *p = buffer;
+  if (a.hi < 0) {
+    *p++ = '-';
+    a = dd_neg(a);
+  }
+
+  /* scale a to [1, 10) */
+  int e = (int)floor(log10(a.hi));
+  a = dd_scale10(a, -e);
+  if (a.hi >= 10) { a = dd_div(a, dd_from_double(10)); e++; }
+  if (a.hi < 1) { a = dd_mul_double(a, 10); e--; }
+
+  char d[DD_DIGITS + 2] = { 0 };
+  if (digits > DD_DIGITS) digits = DD_DIGITS;
+  for (int i = 0; i <= digits; i++) {
+    int digit = (int)floor(a.hi);
+    if (digit < 0) digit = 0;
+    if (digit > 9) digit = 9;
+    d[i] = (char)digit;
+    a = dd_mul_double(dd_sub(a, dd_from_double(digit)), 10);
+  }
+
+  /* round on the extra digit */
+  if (d[digits] >= 5) {
+    int i = digits - 1;
+    while (i >= 0 && d[i] == 9) d[i--] = 0;
+    if (i >= 0) {
+      d[i]++;
+    } else {
+      d[0] = 1;
+      e++;
+    }
+  }
+
+  int last = digits - 1;
+  while (last > 0 && d[last] == 0) last--;
+
+  if (e >= 10 || e < -6) {
+    *p++ = '0' + d[0];
+    if (last > 0) *p++ = '.';
+    for (int i = 1; i <= last; i++) *p++ = '0' + d[i];
+    sprintf(p, "e%+03d", e);
+    return;
+  }
+
+  if (e < 0) {
+    *p++ = '0';
+    *p++ = '.';
+    for (int i = -1; i > e; i--) *p++ = '0';
+    for (int i = 0; i <= last; i++) *p++ = '0' + d[i];
+  } else {
+    for (int i = 0; i <= e; i++) *p++ = '0' + (i <= last ? d[i] : 0);
+    if (last > e) {
+      *p++ = '.';
+      for (int i = e + 1; i <= last; i++) *p++ = '0' + d[i];
+    }
+  }
+  *p = '\0';
+}
@@ -0,0 +1,337 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/* dc2.c -- Dave's (RPN) Calculator
+ *
+ * A simple RPN calculator for terminal
+ * made with love in Italy.
+ *
+ * Copyright 2025 Davide Mastromatteo
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation version 2 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+/* ------------------------
+   AUTOMATIC DIFFERENTIATION
+   ------------------------ */
+
+/* Expressions are evaluated on dual numbers carrying, next to the value,
+   the derivatives along every variable (all the seed directions in a
+   single pass) and the second derivative along the first variable,
+   needed by the Newton steps of minimize */
+
+#define SOLVE_MAX_ITERATIONS 100
+
+typedef struct {
+  double v;
+  double d[EXPR_MAX_VARIABLES];
+  double h;
+} dual;
+
+dual dual_constant(double value) {
+  dual r = { value, { 0 }, 0 };
+  return r;
+}
+
+int dual_is_constant(dual a) {
+  for (int i = 0; i < EXPR_MAX_VARIABLES; i++) if (a.d[i] != 0) return 0;
+  return a.h == 0;
+}
+
+/* Chain rule for f(u), given f(u), f'(u) and f''(u) */
+dual dual_chain(dual u, double f0, double f1, double f2) {
+  dual r;
+  r.v = f0;
+  for (int i = 0; i < EXPR_MAX_VARIABLES; i++) r.d[i] = f1 * u.d[i];
+  r.h = f1 * u.h + f2 * u.d[0] * u.d[0];
+  return r;
+}
+
+/* Multiply a dual number by a constant */
+dual dual_scale(dual u, double k) {
+  return dual_chain(u, u.v * k, k, 0);
+}
+
+dual dual_add(dual a, dual b, double sign) {
+  dual r;
+  r.v = a.v + sign * b.v;
+  for (int i = 0; i < EXPR_MAX_VARIABLES; i++) r.d[i] = a.d[i] + sign * b.d[i];
+  r.h = a.h + sign * b.h;
+  return r;
+}
+
+dual dual_mul(dual a, dual b) {
+  dual r;
+  r.v = a.v * b.v;
+  for (int i = 0; i < EXPR_MAX_VARIABLES; i++) r.d[i] = a.d[i] * b.v + a.v * b.d[i];
+  r.h = a.h * b.v + 2 * a.d[0] * b.d[0] + a.v * b.h;
+  return r;
+}
+
+dual dual_reciprocal(dual u) {
+  double r = 1 / u.v;
+  return dual_chain(u, r, -r * r, 2 * r * r * r);
+}
+
+dual dual_exp(dual u) {
+  double e = exp(u.v);
+  return dual_chain(u, e, e, e);
+}
+
+dual dual_log(dual u) {
+  return dual_chain(u, log(u.v), 1 / u.v, -1 / (u.v * u.v));
+}
+
+/* Compute y^x, following the order of the operands of to_power() */
+dual dual_power(dual x, dual y) {
+  if (dual_is_constant(x)) {
+    double c = x.v;
+    double f1 = (c == 0) ? 0 : c * pow(y.v, c - 1);
+    double f2 = (c == 0 || c == 1) ? 0 : c * (c - 1) * pow(y.v, c - 2);
+    return dual_chain(y, pow(y.v, c), f1, f2);
+  }
+  if (dual_is_constant(y)) {
+    double p = pow(y.v, x.v);
+    double l = log(y.v);
+    return dual_chain(x, p, p * l, p * l * l);
+  }
+  return dual_exp(dual_mul(x, dual_log(y)));
+}
+
+/* Apply a single operand operation with its derivative rule.
+   Returns 0 if the operation has no rule */
+int dual_operation_1o(operation_1o f, dual u, dual *r) {
+  double v = u.v;
+
+  if (f == sqrt) {
+    double s = sqrt(v);
+    *r = dual_chain(u, s, 0.5 / s, -0.25 / (s * v));
+  } else if (f == log || f == fast_log) {
+    *r = dual_log(u);
+  } else if (f == log10 || f == fast_log10) {
+    *r = dual_chain(u, log10(v), 1 / (v * M_LN10), -1 / (v * v * M_LN10));
+  } else if (f == exp || f == fast_exp) {
+    *r = dual_exp(u);
+  } else if (f == reciprocal) {
+    *r = dual_reciprocal(u);
+  } else if (f == factorial || f == exact_factorial) {
+    /* d/dx gamma(x + 1) = gamma(x + 1) digamma(x + 1) */
+    double g = tgamma(v + 1);
+    double psi = digamma(v + 1);
+    *r = dual_chain(u, g, g * psi, g * (psi * psi + trigamma(v + 1)));
+  } else {
+    return 0;
+  }
+  return 1;
+}
+
+/* Apply a trigonometric operation with its derivative rule,
+   in the angle mode recorded with the operation */
+int dual_trigonometric_operation_1o(operation_1o f, char angle_mode, dual u, dual *r) {
+  double k = (angle_mode == 'd') ? M_PI / 180 : 1;
+  double value = trigonometric_in_mode(f, u.v, angle_mode);
+
+  if (!is_inverse_trigonometric(f)) {
+    double s, c;
+    u = dual_scale(u, k);
+    s = sin(u.v);
+    c = cos(u.v);
+    if (f == sin || f == fast_sin) {
+      *r = dual_chain(u, value, c, -s);
+    } else if (f == cos || f == fast_cos) {
+      *r = dual_chain(u, value, -s, -c);
+    } else if (f == tan || f == fast_tan) {
+      double t = s / c;
+      *r = dual_chain(u, value, 1 + t * t, 2 * t * (1 + t * t));
+    } else {
+      return 0;
+    }
+    return 1;
+  }
+
+  double v = u.v;
+  if (f == asin || f == acos) {
+    double q = 1 - v * v;
+    double d1 = 1 / sqrt(q);
+    double d2 = v / (q * sqrt(q));
+    if (f == acos) {
+      d1 = -d1;
+      d2 = -d2;
+    }
+    *r = dual_chain(u, value, d1 / k, d2 / k);
+  } else if (f == atan || f == fast_atan) {
+    double q = 1 + v * v;
+    *r = dual_chain(u, value, 1 / (q * k), -2 * v / (q * q * k));
+  } else {
+    return 0;
+  }
+  return 1;
+}
+
+/* Apply a two-operands operation with its derivative rule.
+   x is the top of the stack, y the one below as in dc2_math.c */
+int dual_operation_2o(operation_2o f, dual x, dual y, dual *r) {
+  if (f == sum) {
+    *r = dual_add(y, x, 1);
+  } else if (f == subtraction) {
+    *r = dual_add(y, x, -1);
+  } else if (f == multiplication) {
+    *r = dual_mul(y, x);
+  } else if (f == division) {
+    *r = dual_mul(y, dual_reciprocal(x));
+  } else if (f == to_power || f == exact_to_power) {
+    *r = dual_power(x, y);
+  } else {
+    return 0;
+  }
+  return 1;
+}
+
+/* Evaluate a program on dual numbers seeding every variable
+   with its own direction. Returns 0 if an operation has no rule */
+int evaluate_dual(expr_program *program, double *variables, dual *result) {
+  dual values[EXPR_MAX_LENGTH];
+  int n = 0;
+
+  for (int i = 0; i < program->length; i++) {
+    expr_instruction *in = &program->code[i];
+    int ok = 1;
+
+    switch (in->kind) {
+    case 'n':
+      values[n++] = dual_constant(in->value);
+      break;
+    case 'v':
+      values[n] = dual_constant(variables[in->variable]);
+      values[n++].d[in->variable] = 1;
+      break;
+    case '1':
+      ok = dual_operation_1o(in->f1, values[n - 1], &values[n - 1]);
+      break;
+    case 't':
+      ok = dual_trigonometric_operation_1o(in->f1, in->angle_mode, values[n - 1], &values[n - 1]);
+      break;
+    case '2':
+      ok = dual_operation_2o(in->f2, values[n - 1], values[n - 2], &values[n - 2]);
+      n--;
+      break;
+    }
+
+    if (!ok) return 0;
+  }
+
+  *result = values[0];
+  return 1;
+}
+
+/* Pop the values of the variables of a program: x is taken
+   from the x register, y from the y register and so on */
+int pop_variables(char *command, expr_program *program, double *variables) {
+  if (sp < program->n_variables) {
+    log_expression_error(command, "not enough values in the stack", "");
+    return 0;
+  }
+  if (refuse_lazy(command, sp - program->n_variables)) return 0;
+  for (int i = 0; i < program->n_variables; i++) variables[i] = pop();
+  return 1;
+}
+
+/* Push back the values of the variables after a failure */
+void push_variables(expr_program *program, double *variables) {
+  for (int i = program->n_variables; i > 0; i--) push(variables[i - 1]);
+}
+
+/* diff <expression>: replace the variables with the value of the
+   expression and its partial derivatives, so that after the command
+   the x register holds df/dx, the y register df/dy and so on */
+void compute_diff(char *expression) {
+  expr_program program;
+  double variables[EXPR_MAX_VARIABLES] = { 0 };
+  dual r;
+
+  if (!parse_expression("diff", expression, &program)) return;
+  if (!pop_variables("diff", &program, variables)) return;
+
+  if (!evaluate_dual(&program, variables, &r)) {
+    push_variables(&program, variables);
+    log_expression_error("diff", "no derivative rule in", expression);
+    return;
+  }
+
+  push(r.v);
+  for (int i = program.n_variables; i > 0; i--) push(r.d[i - 1]);
+
+  snprintf(operation_log[n_operation_log], sizeof(operation_log[0]),
+           "diff %s = %lg, %lg", expression, r.v, r.d[0]);
+  n_operation_log ++;
+}
+
+/* Newton iterations on a function of x only, stepping by
+   f/f' (solve) or f'/f'' (minimize) */
+void newton(char *command, char *expression, int minimize) {
+  expr_program program;
+  double x;
+  dual r;
+
+  if (!parse_expression(command, expression, &program)) return;
+  if (program.n_variables > 1) {
+    log_expression_error(command, "only x can be used in", expression);
+    return;
+  }
+  if (sp < 1 || refuse_lazy(command, sp - 1)) return;
+
+  double start = pop();
+  x = start;
+
+  for (int i = 0; i < SOLVE_MAX_ITERATIONS; i++) {
+    if (!evaluate_dual(&program, &x, &r)) {
+      push(start);
+      log_expression_error(command, "no derivative rule in", expression);
+      return;
+    }
+
+    double step;
+    if (minimize) {
+      /* going downhill also where the function is not convex */
+      step = r.d[0] / fabs(r.h);
+      if (r.d[0] == 0) step = 0;
+    } else {
+      step = r.v / r.d[0];
+      if (r.v == 0) step = 0;
+    }
+
+    if (!isfinite(step)) break;
+    x -= step;
+    if (fabs(step) <= 4 * DBL_EPSILON * fmax(1, fabs(x))) {
+      push(x);
+      snprintf(operation_log[n_operation_log], sizeof(operation_log[0]),
+               "%s %s = %lg", command, expression, x);
+      n_operation_log ++;
+      return;
+    }
+  }
+
+  push(start);
+  log_expression_error(command, "no convergence for", expression);
+}
+
+/* solve <expression>: find a root of the expression
+   starting from the value in the x register */
+void compute_solve(char *expression) {
+  newton("solve", expression, 0);
+}
+
+/* minimize <expression>: find a minimum of the expression
+   starting from the value in the x register */
+void compute_minimize(char *expression) {
+  newton("minimize", expression, 1);
+}
@@ -0,0 +1,225 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/* dc2.c -- Dave's (RPN) Calculator
+ *
+ * A simple RPN calculator for terminal
+ * made with love in Italy.
+ *
+ * Copyright 2025 Davide Mastromatteo
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation version 2 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+/* -----------
+   EXPRESSIONS
+   ----------- */
+
+/* An expression is a line of RPN tokens using the variables x, y and z,
+   e.g. "x 2 ^ y sin *". It is parsed once into a program made of the
+   same operations the calculator uses, so every command accepted at the
+   prompt can be used in an expression. The operations are chosen, and
+   the angle mode of the trigonometric ones recorded, when parsing */
+
+#define EXPR_MAX_LENGTH 64
+#define EXPR_MAX_VARIABLES 3
+#define EXPR_BLOCK 64
+
+typedef struct {
+  char kind;          /* n = number, v = variable, 1 = single operand,
+                         t = trigonometric, 2 = two operands */
+  double value;
+  int variable;
+  operation_1o f1;
+  operation_2o f2;
+  char angle_mode;    /* of the trigonometric operations */
+} expr_instruction;
+
+typedef struct {
+  expr_instruction code[EXPR_MAX_LENGTH];
+  int length;
+  int n_variables;
+  int max_depth;
+} expr_program;
+
+/* Log an error about an expression in the history */
+void log_expression_error(char *command, char *message, char *token) {
+  snprintf(operation_log[n_operation_log], sizeof(operation_log[0]),
+           "%s: %s %s", command, message, token);
+  n_operation_log ++;
+}
+
+/* Parse an expression into a program.
+   Returns 1 on success, 0 (logging the reason) on error */
+int parse_expression(char *command, char *text, expr_program *program) {
+  char buffer[INPUT_BUFFER];
+  int depth = 0;
+
+  strncpy(buffer, text, INPUT_BUFFER - 1);
+  buffer[INPUT_BUFFER - 1] = '\0';
+
+  program->length = 0;
+  program->n_variables = 0;
+  program->max_depth = 0;
+
+  for (char *token = strtok(buffer, " "); token; token = strtok(NULL, " ")) {
+    expr_instruction *in = &program->code[program->length];
+    double value = 0;
+    int is_numeric = 0;
+
+    if (program->length >= EXPR_MAX_LENGTH) {
+      log_expression_error(command, "expression too long at", token);
+      return 0;
+    }
+
+    set_input_if_numeric(token, &value, &is_numeric);
+
+    if (is_numeric) {
+      in->kind = 'n';
+      in->value = value;
+      depth++;
+    } else if (strcmp(token, "pi") == 0 || strcmp(token, "e") == 0) {
+      in->kind = 'n';
+      in->value = (token[0] == 'p') ? M_PI : M_E;
+      depth++;
+    } else if (strlen(token) == 1 && token[0] >= 'x' && token[0] <= 'z') {
+      in->kind = 'v';
+      in->variable = token[0] - 'x';
+      if (in->variable + 1 > program->n_variables) program->n_variables = in->variable + 1;
+      depth++;
+    } else if ((in->f2 = get_operation_2o(token))) {
+      in->kind = '2';
+      depth--;
+    } else if ((in->f1 = get_operation_1o(token))) {
+      in->kind = '1';
+    } else if ((in->f1 = get_trigonometric_operation_1o(token))) {
+      in->kind = 't';
+      in->angle_mode = mode;
+    } else {
+      log_expression_error(command, "unknown token", token);
+      return 0;
+    }
+
+    if (depth < 1) {
+      log_expression_error(command, "missing operand for", token);
+      return 0;
+    }
+    if (depth > program->max_depth) program->max_depth = depth;
+    program->length++;
+  }
+
+  if (depth != 1) {
+    log_expression_error(command, "the expression must leave one value", "");
+    return 0;
+  }
+
+  return 1;
+}
+
+/* Evaluate a program with the given values of the variables */
+double evaluate_expression(expr_program *program, const double *variables) {
+  double values[EXPR_MAX_LENGTH];
+  int n = 0;
+
+  for (int i = 0; i < program->length; i++) {
+    expr_instruction *in = &program->code[i];
+
+    switch (in->kind) {
+    case 'n':
+      values[n++] = in->value;
+      break;
+    case 'v':
+      values[n++] = variables[in->variable];
+      break;
+    case '1':
+      values[n - 1] = in->f1(values[n - 1]);
+      break;
+    case 't':
+      values[n - 1] = trigonometric_in_mode(in->f1, values[n - 1], in->angle_mode);
+      break;
+    case '2':
+      values[n - 2] = in->f2(values[n - 1], values[n - 2]);
+      n--;
+      break;
+    }
+  }
+
+  return values[0];
+}
+
+/* Check if a program uses operations that have a bulk version */
+int has_bulk_operations(expr_program *program) {
+  for (int i = 0; i < program->length; i++) {
+    expr_instruction *in = &program->code[i];
+    if (in->kind == '1' && get_bulk_operation_1o(in->f1)) return 1;
+    if (in->kind == 't' && in->angle_mode != 'd' && get_bulk_operation_1o(in->f1)) return 1;
+  }
+  return 0;
+}
+
+/* Evaluate a program of x on n values in place. It runs an instruction
+   at a time on blocks of EXPR_BLOCK values, so that the operations with
+   a bulk version are applied to arrays. The results are the same as
+   those of evaluate_expression() */
+void evaluate_expression_many(expr_program *program, double *v, long n) {
+  double values[EXPR_MAX_LENGTH][EXPR_BLOCK];
+
+  for (long start = 0; start < n; start += EXPR_BLOCK) {
+    long m = (n - start < EXPR_BLOCK) ? n - start : EXPR_BLOCK;
+    int depth = 0;
+
+    for (int i = 0; i < program->length; i++) {
+      expr_instruction *in = &program->code[i];
+      double *a = (depth >= 1) ? values[depth - 1] : NULL;
+      double *b = (depth >= 2) ? values[depth - 2] : NULL;
+      operation_many bulk = NULL;
+
+      switch (in->kind) {
+      case 'n':
+        for (long j = 0; j < m; j++) values[depth][j] = in->value;
+        depth++;
+        break;
+      case 'v':
+        memcpy(values[depth], &v[start], m * sizeof(double));
+        depth++;
+        break;
+      case '1':
+      case 't':
+        if (in->kind == '1' || in->angle_mode != 'd') bulk = get_bulk_operation_1o(in->f1);
+        if (bulk) {
+          bulk(a, m);
+        } else if (in->kind == '1') {
+          for (long j = 0; j < m; j++) a[j] = in->f1(a[j]);
+        } else {
+          for (long j = 0; j < m; j++) a[j] = trigonometric_in_mode(in->f1, a[j], in->angle_mode);
+        }
+        break;
+      case '2':
+        if (in->f2 == sum) {
+          for (long j = 0; j < m; j++) b[j] = b[j] + a[j];
+        } else if (in->f2 == subtraction) {
+          for (long j = 0; j < m; j++) b[j] = b[j] - a[j];
+        } else if (in->f2 == multiplication) {
+          for (long j = 0; j < m; j++) b[j] = b[j] * a[j];
+        } else if (in->f2 == division) {
+          for (long j = 0; j < m; j++) b[j] = b[j] / a[j];
+        } else {
+          for (long j = 0; j < m; j++) b[j] = in->f2(a[j], b[j]);
+        }
+        depth--;
+        break;
+      }
+    }
+
+    memcpy(&v[start], values[0], m * sizeof(double));
+  }
+}
@@ -0,0 +1,404 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/* dc2.c -- Dave's (RPN) Calculator
+ *
+ * A simple RPN calculator for terminal
+ * made with love in Italy.
+ *
+ * Copyright 2025 Davide Mastromatteo
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation version 2 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+/* -------------------
+   FAST MATH FUNCTIONS
+   ------------------- */
+
+/* Polynomial approximations of the transcendental functions used in
+   the "fast" precision. They use no lookup tables and, apart from the
+   libm fallback of the trigonometric functions for huge arguments, no
+   branches: selects and bit operations only, so loops calling them can
+   be vectorised by the compiler (with -fno-trapping-math).
+
+   The _many versions apply a function to an array in place, and are
+   what map and the sequences use. They are compiled with the loop
+   vectoriser of -O3 and, on x86-64, twice: for AVX2 and for SSE2, the
+   one for the machine being picked when dc2 starts. Without FMA
+   contraction every lane computes exactly what the scalar function
+   does. The trigonometric ones take the libm fallback only for arrays
+   with an argument beyond FAST_TRIG_MAX, outside the vector loop.
+
+   Maximum errors measured against the long double libm functions over
+   10^7 random arguments in each range:
+     fast_exp    [-707.7, 709.78]      1 ulp  (below: flushed to 0)
+     fast_log    [2^-1022, 2^1023]     1.5 ulp
+     fast_sin    [-10^5, 10^5]         2.5 ulp  (outside: libm)
+     fast_cos    [-10^5, 10^5]         2.5 ulp  (outside: libm)
+     fast_tan    [-10^5, 10^5]         4 ulp  (outside: libm)
+     fast_atan   all doubles           2.5 ulp
+
+   The coefficients are Chebyshev fits of the reduced functions. */
+
+#define FAST_TRIG_MAX 1e5
+
+/* pi/2 split in three parts, the first two with 33 bits so that
+   j * part is exact for the quadrants allowed by FAST_TRIG_MAX */
+#define PI_2_PART1 1.5707963267341256
+#define PI_2_PART2 6.077100506303966e-11
+#define PI_2_PART3 2.0222662487959506e-21
+
+/* Adding and subtracting 1.5 * 2^52 rounds to the nearest integer
+   without a call to nearbyint() */
+#define ROUND_SHIFTER 6755399441055744.0
+
+#define LN2_HI 0.6931471803691238
+#define LN2_LO 1.9082149292705877e-10
+
+uint64_t double_to_bits(double x) {
+  uint64_t bits;
+  memcpy(&bits, &x, sizeof(bits));
+  return bits;
+}
+
+double bits_to_double(uint64_t bits) {
+  double x;
+  memcpy(&x, &bits, sizeof(x));
+  return x;
+}
+
+/* sin(r) for |r| <= pi/4 */
+double sin_kernel(double r) {
+  double t = r * r;
+  double p = 1.5918129294866608e-10;
+  p = p * t - 2.5051131845003624e-08;
+  p = p * t + 2.755731610255244e-06;
+  p = p * t - 0.00019841269836758574;
+  p = p * t + 0.008333333333330948;
+  p = p * t - 0.16666666666666666;
+  return r + r * t * p;
+}
+
+/* cos(r) for |r| <= pi/4 */
+double cos_kernel(double r) {
+  double t = r * r;
+  double p = -1.1382632425521717e-11;
+  p = p * t + 2.08761462684032e-09;
+  p = p * t - 2.7557317271729793e-07;
+  p = p * t + 2.480158729876569e-05;
+  p = p * t - 0.0013888888888887398;
+  p = p * t + 0.041666666666666664;
+  double hr = 0.5 * t;
+  double w = 1.0 - hr;
+  return w + (((1.0 - w) - hr) + t * t * p);
+}
+
+/* Reduce x to r in [-pi/4, pi/4] returning the quadrant in the
+   two lowest bits. The quadrant is read from the bits of the rounding
+   shifter instead of converting j to an integer */
+uint64_t reduce_quadrant(double x, double *r) {
+  double shifted = x * M_2_PI + ROUND_SHIFTER;
+  double j = shifted - ROUND_SHIFTER;
+  *r = ((x - j * PI_2_PART1) - j * PI_2_PART2) - j * PI_2_PART3;
+  return double_to_bits(shifted);
+}
+
+/* Sine and cosine of a reduced argument placed in their quadrant:
+   odd quadrants swap sine and cosine, the sign bits follow q and q + 1 */
+void sincos_quadrant(double sr, double cr, uint64_t q, double *s, double *c) {
+  uint64_t swap = (uint64_t)0 - (q & 1);
+  uint64_t sb = double_to_bits(sr), cb = double_to_bits(cr);
+  uint64_t sin_bits = (sb & ~swap) | (cb & swap);
+  uint64_t cos_bits = (cb & ~swap) | (sb & swap);
+  *s = bits_to_double(sin_bits ^ ((q & 2) << 62));
+  *c = bits_to_double(cos_bits ^ (((q + 1) & 2) << 62));
+}
+
+/* Compute sine and cosine sharing the argument reduction,
+   for |x| <= FAST_TRIG_MAX */
+void fast_sincos_reduced(double x, double *s, double *c) {
+  double r;
+  uint64_t q = reduce_quadrant(x, &r);
+  sincos_quadrant(sin_kernel(r), cos_kernel(r), q, s, c);
+}
+
+/* Compute sine and cosine sharing the argument reduction */
+void fast_sincos(double x, double *s, double *c) {
+  if (fabs(x) > FAST_TRIG_MAX) {
+    *s = sin(x);
+    *c = cos(x);
+    return;
+  }
+  fast_sincos_reduced(x, s, c);
+}
+
+double fast_sin(double x) {
+  double s, c;
+  fast_sincos(x, &s, &c);
+  return s;
+}
+
+double fast_cos(double x) {
+  double s, c;
+  fast_sincos(x, &s, &c);
+  return c;
+}
+
+double fast_tan(double x) {
+  double s, c;
+  fast_sincos(x, &s, &c);
+  return s / c;
+}
+
+/* exp(x) = 2^n exp(r) with x = n ln2 + r and |r| <= ln2/2.
+   2^(n-1) is built from the bits of the rounding shifter, the other
+   factor 2 goes into the polynomial so that n = 1024 does not overflow */
+double fast_exp(double x) {
+  double xc = x > 709.78 ? 709.78 : (x < -707.7 ? -707.7 : x);
+  double shifted = xc * M_LOG2E + ROUND_SHIFTER;
+  double n = shifted - ROUND_SHIFTER;
+  double r = (xc - n * LN2_HI) - n * LN2_LO;
+  double p = 2.0914679376583935e-09;
+  p = p * r + 2.510520637395701e-08;
+  p = p * r + 2.7557273661348637e-07;
+  p = p * r + 2.7557255425746435e-06;
+  p = p * r + 2.4801587325533363e-05;
+  p = p * r + 0.00019841269874800493;
+  p = p * r + 0.0013888888888883752;
+  p = p * r + 0.008333333333326141;
+  p = p * r + 0.04166666666666667;
+  p = p * r + 0.1666666666666667;
+  p = p * r + 0.5;
+  double e = 2.0 + 2.0 * (r + r * r * p);
+  double scale = bits_to_double((double_to_bits(shifted) + 1022) << 52);
+  double result = e * scale;
+  result = x > 709.78 ? INFINITY : result;
+  result = x < -707.7 ? 0.0 : result;
+  return x != x ? x : result;
+}
+
+/* log(x) = e ln2 + log(m) with m in [sqrt(1/2), sqrt(2)),
+   log(m) = 2 atanh(s) with s = (m - 1) / (m + 1).
+   The exponent is turned into a double with the same shifter trick */
+double fast_log(double x) {
+  /* subnormal numbers are scaled into the normal range first */
+  int subnormal = x < 2.2250738585072014e-308;
+  double xs = subnormal ? x * 18014398509481984.0 : x;
+  uint64_t bits = double_to_bits(xs);
+  double e = bits_to_double((bits >> 52) | 0x4330000000000000ULL) - 4503599627371519.0;
+  e = subnormal ? e - 54 : e;
+  double m = bits_to_double((bits & 0x000fffffffffffffULL) | 0x3ff0000000000000ULL);
+  int big = m > M_SQRT2;
+  m = big ? m * 0.5 : m;
+  e = big ? e + 1 : e;
+
+  double f = m - 1.0;
+  double s = f / (2.0 + f);
+  double t = s * s;
+  double p = 0.13086626147840102;
+  p = p * t + 0.13268773138656886;
+  p = p * t + 0.15386239702814658;
+  p = p * t + 0.18181795640132906;
+  p = p * t + 0.22222222391713917;
+  p = p * t + 0.28571428570803614;
+  p = p * t + 0.4000000000000088;
+  p = p * t + 0.6666666666666666;
+  double hf = 0.5 * f * f;
+  double lm = f - (hf - s * (hf + t * p));
+  double result = e * LN2_HI + (lm + e * LN2_LO);
+
+  result = x == INFINITY ? x : result;
+  result = x == 0 ? -INFINITY : result;
+  return (x < 0 || x != x) ? NAN : result;
+}
+
+double fast_log10(double x) {
+  return fast_log(x) * M_LOG10E;
+}
+
+/* atan(x) is reduced to |x| <= tan(pi/8) using
+   atan(x) = pi/2 - atan(1/x) and atan(x) = pi/4 + atan((x-1)/(x+1)) */
+double fast_atan(double x) {
+  double a = fabs(x);
+  int inverted = a > 1.0;
+  double b = inverted ? 1.0 / a : a;
+  int shifted = b > 0.41421356237309503;
+  double c = shifted ? (b - 1.0) / (b + 1.0) : b;
+
+  double t = c * c;
+  double p = -0.01391822929102443;
+  p = p * t + 0.030635704112969498;
+  p = p * t - 0.04104436265755082;
+  p = p * t + 0.04719395030027433;
+  p = p * t - 0.05258041554297779;
+  p = p * t + 0.058819252531928636;
+  p = p * t - 0.06666642020055166;
+  p = p * t + 0.07692306736000173;
+  p = p * t - 0.0909090906700999;
+  p = p * t + 0.11111111110754729;
+  p = p * t - 0.14285714285711518;
+  p = p * t + 0.19999999999999993;
+  p = p * t - 0.3333333333333333;
+  double r = c + c * t * p;
+
+  r = shifted ? M_PI_4 + r : r;
+  r = inverted ? M_PI_2 - r : r;
+  return copysign(r, x);
+}
+
+#if defined(__GNUC__) && !defined(__clang__) && defined(__x86_64__)
+#define FAST_BULK __attribute__((target_clones("avx2", "default"), optimize("O3")))
+#define FAST_FALLBACK __attribute__((noinline))
+#else
+#define FAST_BULK
+#define FAST_FALLBACK
+#endif
+
+FAST_BULK void fast_exp_many(double *v, long n) {
+  for (long i = 0; i < n; i++) v[i] = fast_exp(v[i]);
+}
+
+FAST_BULK void fast_log_many(double *v, long n) {
+  for (long i = 0; i < n; i++) v[i] = fast_log(v[i]);
+}
+
+FAST_BULK void fast_log10_many(double *v, long n) {
+  for (long i = 0; i < n; i++) v[i] = fast_log10(v[i]);
+}
+
+FAST_BULK void fast_atan_many(double *v, long n) {
+  for (long i = 0; i < n; i++) v[i] = fast_atan(v[i]);
+}
+
+/* Count the arguments needing the libm fallback */
+FAST_BULK long fast_trig_outside(const double *v, long n) {
+  long outside = 0;
+  for (long i = 0; i < n; i++) outside += fabs(v[i]) > FAST_TRIG_MAX;
+  return outside;
+}
+
+/* Apply a function one value at a time. Kept out of line, as the calls
+   to libm inlined in a bulk function stop its loops from vectorising */
+FAST_FALLBACK void fast_apply(double (*f)(double), double *v, long n) {
+  for (long i = 0; i < n; i++) v[i] = f(v[i]);
+}
+
+FAST_BULK void fast_sin_many(double *v, long n) {
+  if (fast_trig_outside(v, n)) {
+    fast_apply(fast_sin, v, n);
+    return;
+  }
+  for (long i = 0; i < n; i++) {
+    double s, c;
+    fast_sincos_reduced(v[i], &s, &c);
+    v[i] = s;
+  }
+}
+
+FAST_BULK void fast_cos_many(double *v, long n) {
+  if (fast_trig_outside(v, n)) {
+    fast_apply(fast_cos, v, n);
+    return;
+  }
+  for (long i = 0; i < n; i++) {
+    double s, c;
+    fast_sincos_reduced(v[i], &s, &c);
+    v[i] = c;
+  }
+}
+
+FAST_BULK void fast_tan_many(double *v, long n) {
+  if (fast_trig_outside(v, n)) {
+    fast_apply(fast_tan, v, n);
+    return;
+  }
+  /* s / c of sincos_quadrant(), with the signs taken out of the
+     division: the same value, in a form the vectoriser accepts */
+  for (long i = 0; i < n; i++) {
+    double r;
+    uint64_t q = reduce_quadrant(v[i], &r);
+    double sr = sin_kernel(r), cr = cos_kernel(r);
+    v[i] = (q & 1) ? -(cr / sr) : sr / cr;
+  }
+}
+
+/* Reduce an angle in degrees to [-45, 45] returning the quadrant.
+   fmod and the subtraction of the multiple of 90 are both exact,
+   so multiples of 90 degrees reduce to exactly 0. Infinities and NaNs
+   have no quadrant: they reduce to NaN, as libm does */
+int reduce_degrees(double x, double *r) {
+  if (!isfinite(x)) {
+    *r = NAN;
+    return 0;
+  }
+
+  double t = fmod(x, 360.0);
+  double q = (t / 90.0 + ROUND_SHIFTER) - ROUND_SHIFTER;
+  *r = t - q * 90.0;
+  return (int)(((int64_t)q % 4 + 4) % 4);
+}
+
+/* Compute sine and cosine of an angle in degrees, with the
+   polynomial kernels when fast is set */
+void sincos_degrees(double x, double *s, double *c, int fast) {
+  double r;
+  int q = reduce_degrees(x, &r);
+  double radians = r * (M_PI / 180.0);
+  double sr, cr;
+  if (fast) {
+    sr = sin_kernel(radians);
+    cr = cos_kernel(radians);
+  } else {
+    sr = sin(radians);
+    cr = cos(radians);
+  }
+  sincos_quadrant(sr, cr, (uint64_t)q, s, c);
+  /* adding zero turns the -0 of the negated quadrants into 0 */
+  *s += 0.0;
+  *c += 0.0;
+}
+
+double sin_degrees(double x) {
+  double s, c;
+  sincos_degrees(x, &s, &c, 0);
+  return s;
+}
+
+double cos_degrees(double x) {
+  double s, c;
+  sincos_degrees(x, &s, &c, 0);
+  return c;
+}
+
+double tan_degrees(double x) {
+  double s, c;
+  sincos_degrees(x, &s, &c, 0);
+  return s / c;
+}
+
+double fast_sin_degrees(double x) {
+  double s, c;
+  sincos_degrees(x, &s, &c, 1);
+  return s;
+}
+
+double fast_cos_degrees(double x) {
+  double s, c;
+  sincos_degrees(x, &s, &c, 1);
+  return c;
+}
+
+double fast_tan_degrees(double x) {
+  double s, c;
+  sincos_degrees(x, &s, &c, 1);
+  return s / c;
+}
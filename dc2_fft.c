@@ -0,0 +1,427 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/* dc2.c -- Dave's (RPN) Calculator
+ *
+ * A simple RPN calculator for terminal
+ * made with love in Italy.
+ *
+ * Copyright 2025 Davide Mastromatteo
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation version 2 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+/* ----------------------------
+   FOURIER TRANSFORM
+   ---------------------------- */
+
+/* Signals are the top n entries of the stack, the oldest sample at the
+   bottom. A spectrum takes two entries per value, the real part below
+   the imaginary one.
+
+   The transform is an iterative radix-2 FFT working on separate arrays
+   of real and imaginary parts, so that the butterflies of a stage are
+   plain loops over contiguous memory. The twiddle factors of every
+   stage are stored one after the other (stage h uses the h entries from
+   h - 1), and they are kept in a small cache of plans keyed by size.
+   Sizes that are not a power of two go through Bluestein's algorithm,
+   which turns the transform into a convolution of power of two size */
+
+#define FFT_CACHE_SIZE 8
+
+/* A direct convolution of m and n values takes m n multiplications,
+   three transforms of size s about s log2(s) butterflies that cost
+   eight times as much: the direct method is used while it is cheaper */
+#define CONV_DIRECT_RATIO 8
+
+typedef struct {
+  long n;
+  double *tw_re;
+  double *tw_im;
+  uint32_t *reverse;
+} fft_plan;
+
+fft_plan fft_cache[FFT_CACHE_SIZE];
+int fft_cache_next = 0;
+
+int is_power_of_two(long n) {
+  return n > 0 && (n & (n - 1)) == 0;
+}
+
+long next_power_of_two(long n) {
+  long m = 1;
+  while (m < n) m <<= 1;
+  return m;
+}
+
+/* Get the plan for a power of two size, building it on a cache miss.
+   Returns NULL if there is not enough memory */
+fft_plan *get_fft_plan(long n) {
+  for (int i = 0; i < FFT_CACHE_SIZE; i++) {
+    if (fft_cache[i].n == n) return &fft_cache[i];
+  }
+
+  fft_plan *plan = &fft_cache[fft_cache_next];
+  fft_cache_next = (fft_cache_next + 1) % FFT_CACHE_SIZE;
+
+  free(plan->tw_re);
+  free(plan->tw_im);
+  free(plan->reverse);
+  plan->n = 0;
+  plan->tw_re = malloc(n * sizeof(double));
+  plan->tw_im = malloc(n * sizeof(double));
+  plan->reverse = malloc(n * sizeof(uint32_t));
+  if (plan->tw_re == NULL || plan->tw_im == NULL || plan->reverse == NULL) return NULL;
+
+  /* every twiddle is computed directly, a recurrence would
+     accumulate rounding errors on long transforms */
+  for (long h = 1; h < n; h <<= 1) {
+    for (long j = 0; j < h; j++) {
+      plan->tw_re[h - 1 + j] = cos(M_PI * j / h);
+      plan->tw_im[h - 1 + j] = -sin(M_PI * j / h);
+    }
+  }
+
+  int bits = 0;
+  while ((1L << bits) < n) bits++;
+  for (long i = 0; i < n; i++) {
+    uint32_t r = 0;
+    for (int b = 0; b < bits; b++) r |= ((i >> b) & 1) << (bits - 1 - b);
+    plan->reverse[i] = r;
+  }
+
+  plan->n = n;
+  return plan;
+}
+
+/* Forward transform of a power of two size, in place */
+int fft_radix2(double *re, double *im, long n) {
+  fft_plan *plan = get_fft_plan(n);
+  if (plan == NULL) return 0;
+
+  for (long i = 0; i < n; i++) {
+    long j = plan->reverse[i];
+    if (i < j) {
+      double t = re[i]; re[i] = re[j]; re[j] = t;
+      t = im[i]; im[i] = im[j]; im[j] = t;
+    }
+  }
+
+  for (long h = 1; h < n; h <<= 1) {
+    double *w_re = plan->tw_re + h - 1;
+    double *w_im = plan->tw_im + h - 1;
+    for (long start = 0; start < n; start += 2 * h) {
+      double *a_re = re + start, *a_im = im + start;
+      double *b_re = a_re + h, *b_im = a_im + h;
+      for (long j = 0; j < h; j++) {
+        double t_re = w_re[j] * b_re[j] - w_im[j] * b_im[j];
+        double t_im = w_re[j] * b_im[j] + w_im[j] * b_re[j];
+        b_re[j] = a_re[j] - t_re;
+        b_im[j] = a_im[j] - t_im;
+        a_re[j] += t_re;
+        a_im[j] += t_im;
+      }
+    }
+  }
+
+  return 1;
+}
+
+/* Forward transform of any size with Bluestein's algorithm:
+   X[k] = w[k] sum x[j] w[j] conj(w[k - j]) with w[k] = exp(-i pi k^2 / n) */
+int fft_bluestein(double *re, double *im, long n) {
+  long m = next_power_of_two(2 * n - 1);
+  double *w_re = malloc(n * sizeof(double));
+  double *w_im = malloc(n * sizeof(double));
+  double *a_re = calloc(m, sizeof(double));
+  double *a_im = calloc(m, sizeof(double));
+  double *b_re = calloc(m, sizeof(double));
+  double *b_im = calloc(m, sizeof(double));
+  int ok = w_re && w_im && a_re && a_im && b_re && b_im;
+
+  if (ok) {
+    for (long k = 0; k < n; k++) {
+      /* k^2 is reduced modulo 2n to keep the angle small and exact */
+      double angle = M_PI * (double)((k * k) % (2 * n)) / n;
+      w_re[k] = cos(angle);
+      w_im[k] = -sin(angle);
+      a_re[k] = re[k] * w_re[k] - im[k] * w_im[k];
+      a_im[k] = re[k] * w_im[k] + im[k] * w_re[k];
+      b_re[k] = w_re[k];
+      b_im[k] = -w_im[k];
+      if (k > 0) {
+        b_re[m - k] = w_re[k];
+        b_im[m - k] = -w_im[k];
+      }
+    }
+
+    ok = fft_radix2(a_re, a_im, m) && fft_radix2(b_re, b_im, m);
+  }
+
+  if (ok) {
+    /* the inverse transform of the product is a forward transform
+       with real and imaginary parts swapped */
+    for (long k = 0; k < m; k++) {
+      double p_re = a_re[k] * b_re[k] - a_im[k] * b_im[k];
+      double p_im = a_re[k] * b_im[k] + a_im[k] * b_re[k];
+      a_re[k] = p_im;
+      a_im[k] = p_re;
+    }
+    ok = fft_radix2(a_re, a_im, m);
+  }
+
+  if (ok) {
+    for (long k = 0; k < n; k++) {
+      double c_re = a_im[k] / m, c_im = a_re[k] / m;
+      re[k] = c_re * w_re[k] - c_im * w_im[k];
+      im[k] = c_re * w_im[k] + c_im * w_re[k];
+    }
+  }
+
+  free(w_re);
+  free(w_im);
+  free(a_re);
+  free(a_im);
+  free(b_re);
+  free(b_im);
+  return ok;
+}
+
+/* Transform n complex values in place, the inverse one scaled by 1/n.
+   Returns 0 if there is not enough memory */
+int fft(double *re, double *im, long n, int inverse) {
+  int ok;
+
+  /* the inverse transform is the forward one of the swapped parts */
+  if (inverse) {
+    double *t = re;
+    re = im;
+    im = t;
+  }
+
+  ok = is_power_of_two(n) ? fft_radix2(re, im, n) : fft_bluestein(re, im, n);
+
+  if (ok && inverse) {
+    for (long k = 0; k < n; k++) {
+      re[k] /= n;
+      im[k] /= n;
+    }
+  }
+  return ok;
+}
+
+/* Convolve a (m values) and b (n values) into out (m + n - 1 values),
+   directly for short signals or with the product of the transforms */
+int convolve(double *a, long m, double *b, long n, double *out) {
+  long length = m + n - 1;
+  long size = next_power_of_two(length);
+
+  if ((double)m * n <= CONV_DIRECT_RATIO * size * log2(size)) {
+    for (long k = 0; k < length; k++) out[k] = 0;
+    for (long i = 0; i < m; i++) {
+      for (long j = 0; j < n; j++) out[i + j] += a[i] * b[j];
+    }
+    return 1;
+  }
+
+  double *a_re = calloc(size, sizeof(double));
+  double *a_im = calloc(size, sizeof(double));
+  double *b_re = calloc(size, sizeof(double));
+  double *b_im = calloc(size, sizeof(double));
+  int ok = a_re && a_im && b_re && b_im;
+
+  if (ok) {
+    memcpy(a_re, a, m * sizeof(double));
+    memcpy(b_re, b, n * sizeof(double));
+    ok = fft(a_re, a_im, size, 0) && fft(b_re, b_im, size, 0);
+  }
+
+  if (ok) {
+    for (long k = 0; k < size; k++) {
+      double p_re = a_re[k] * b_re[k] - a_im[k] * b_im[k];
+      double p_im = a_re[k] * b_im[k] + a_im[k] * b_re[k];
+      a_re[k] = p_re;
+      a_im[k] = p_im;
+    }
+    ok = fft(a_re, a_im, size, 1);
+  }
+
+  if (ok) memcpy(out, a_re, length * sizeof(double));
+
+  free(a_re);
+  free(a_im);
+  free(b_re);
+  free(b_im);
+  return ok;
+}
+
+/* Pop the length of a signal from the x register, checking that the
+   stack holds it (entries per value each) and making room for
+   growth entries more. Returns 0 (logging why) on error */
+long pop_signal_length(char *name, int entries, long growth) {
+  if (sp < 2) return 0;
+
+  double n = pop();
+  if (n != floor(n) || n < 1 || n * entries > sp) {
+    push(n);
+    sprintf(operation_log[n_operation_log], "%s: not a signal length %lg", name, n);
+    n_operation_log ++;
+    return 0;
+  }
+  if (refuse_lazy(name, sp - (long)n * entries)) {
+    push(n);
+    return 0;
+  }
+  if (!reserve_stack(growth * (long)n)) {
+    push(n);
+    sprintf(operation_log[n_operation_log], "%s: not enough room in the stack", name);
+    n_operation_log ++;
+    return 0;
+  }
+  return (long)n;
+}
+
+/* Allocate the real and imaginary parts of a signal */
+int alloc_signal(long n, double **re, double **im) {
+  *re = calloc(n, sizeof(double));
+  *im = calloc(n, sizeof(double));
+  if (*re == NULL || *im == NULL) {
+    free(*re);
+    free(*im);
+    printf("Out Of Memory\n");
+    return 0;
+  }
+  return 1;
+}
+
+/* Replace the x register (n) and the n values below with their
+   spectrum, n pairs of real and imaginary parts */
+void fft_operation(void) {
+  double *re, *im;
+  long n = pop_signal_length("fft", 1, 1);
+
+  if (n == 0 || !alloc_signal(n, &re, &im)) return;
+
+  double *signal = &stack[sp - n];
+  memcpy(re, signal, n * sizeof(double));
+  if (fft(re, im, n, 0)) {
+    for (long k = 0; k < n; k++) {
+      signal[2 * k] = re[k];
+      signal[2 * k + 1] = im[k];
+    }
+    sp += n;
+    memset(&stack_lo[sp - 2 * n], 0, 2 * n * sizeof(double));
+    sprintf(operation_log[n_operation_log], "fft of %ld values", n);
+  } else {
+    sprintf(operation_log[n_operation_log], "fft: out of memory");
+  }
+  n_operation_log ++;
+
+  free(re);
+  free(im);
+}
+
+/* Replace the x register (n) and the n pairs of real and imaginary
+   parts below with the real part of their inverse transform */
+void ifft_operation(void) {
+  double *re, *im;
+  long n = pop_signal_length("ifft", 2, 0);
+
+  if (n == 0 || !alloc_signal(n, &re, &im)) return;
+
+  double *spectrum = &stack[sp - 2 * n];
+  for (long k = 0; k < n; k++) {
+    re[k] = spectrum[2 * k];
+    im[k] = spectrum[2 * k + 1];
+  }
+  if (fft(re, im, n, 1)) {
+    memcpy(spectrum, re, n * sizeof(double));
+    sp -= n;
+    memset(&stack_lo[sp - n], 0, n * sizeof(double));
+    sprintf(operation_log[n_operation_log], "ifft of %ld values", n);
+  } else {
+    sprintf(operation_log[n_operation_log], "ifft: out of memory");
+  }
+  n_operation_log ++;
+
+  free(re);
+  free(im);
+}
+
+/* Replace the x register (n) and the n values below with their power
+   spectral density |X[k]|^2 / n for k = 0 ... n / 2 */
+void psd_operation(void) {
+  double *re, *im;
+  long n = pop_signal_length("psd", 1, 0);
+
+  if (n == 0 || !alloc_signal(n, &re, &im)) return;
+
+  double *signal = &stack[sp - n];
+  memcpy(re, signal, n * sizeof(double));
+  if (fft(re, im, n, 0)) {
+    long bins = n / 2 + 1;
+    for (long k = 0; k < bins; k++) signal[k] = (re[k] * re[k] + im[k] * im[k]) / n;
+    sp -= n - bins;
+    memset(&stack_lo[sp - bins], 0, bins * sizeof(double));
+    sprintf(operation_log[n_operation_log], "psd of %ld values", n);
+  } else {
+    sprintf(operation_log[n_operation_log], "psd: out of memory");
+  }
+  n_operation_log ++;
+
+  free(re);
+  free(im);
+}
+
+/* Convolve two signals: the x register holds the length n of the
+   second one, the y register the length m of the first one, and
+   below them are the m values of the first signal and the n values
+   of the second. They are replaced by the m + n - 1 values of the
+   convolution */
+void conv_operation(void) {
+  if (sp < 3) return;
+
+  double n = pop();
+  double m = pop();
+  if (n != floor(n) || m != floor(m) || n < 1 || m < 1 || n + m > sp) {
+    push(m);
+    push(n);
+    sprintf(operation_log[n_operation_log], "conv: not signal lengths %lg %lg", m, n);
+    n_operation_log ++;
+    return;
+  }
+  if (refuse_lazy("conv", sp - (long)(m + n))) {
+    push(m);
+    push(n);
+    return;
+  }
+
+  long length = (long)(m + n - 1);
+  double *a = &stack[sp - (long)(m + n)];
+  double *out = malloc(length * sizeof(double));
+  if (out == NULL || !convolve(a, (long)m, a + (long)m, (long)n, out)) {
+    free(out);
+    push(m);
+    push(n);
+    sprintf(operation_log[n_operation_log], "conv: out of memory");
+    n_operation_log ++;
+    return;
+  }
+
+  memcpy(a, out, length * sizeof(double));
+  sp -= 1;
+  memset(&stack_lo[sp - length], 0, length * sizeof(double));
+  free(out);
+
+  sprintf(operation_log[n_operation_log], "conv of %lg and %lg values", m, n);
+  n_operation_log ++;
+}
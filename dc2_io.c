@@ -0,0 +1,255 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/* dc2.c -- Dave's (RPN) Calculator
+ *
+ * A simple RPN calculator for terminal
+ * made with love in Italy.
+ *
+ * Copyright 2025 Davide Mastromatteo
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation version 2 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+/* ----------------
+   LOAD AND SAVE
+   ---------------- */
+
+/* The format of a file follows its extension: .bin, .f64 and .raw are
+   raw little-endian float64 values, .csv are values separated by commas
+   or newlines, anything else is text with values separated by blanks.
+
+   Loaded files are mapped in memory. Binary values are copied into the
+   stack as they are, text is parsed in place. Saves go through a large
+   buffer, so that even text needs few write calls */
+
+#define IO_BUFFER_SIZE (1 << 20)
+#define IO_MAX_TOKEN 64
+
+/* file given with --save, written when dc2 quits */
+char *save_on_quit = NULL;
+
+/* Get the format of a file from its extension:
+   b = binary, c = CSV, t = text */
+char file_format(char *path) {
+  char *dot = strrchr(path, '.');
+
+  if (dot == NULL) return 't';
+  if (strcmp(dot, ".bin") == 0 || strcmp(dot, ".f64") == 0 || strcmp(dot, ".raw") == 0) return 'b';
+  if (strcmp(dot, ".csv") == 0) return 'c';
+  return 't';
+}
+
+void log_io_error(char *command, char *path, char *message) {
+  snprintf(operation_log[n_operation_log], sizeof(operation_log[0]),
+           "%s %s: %s", command, path, message);
+  n_operation_log ++;
+}
+
+/* Swap the bytes of the values when the machine is big-endian */
+void little_endian_values(double *v, long n) {
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+  for (long i = 0; i < n; i++) v[i] = bits_to_double(__builtin_bswap64(double_to_bits(v[i])));
+#else
+  (void)v;
+  (void)n;
+#endif
+}
+
+/* A file can hold NaNs with the tag of a sequence (nan(0x...) in
+   text), which must not become sequences: they are made plain NaNs */
+void plain_values(double *v, long n) {
+  for (long i = 0; i < n; i++) {
+    if (has_lazy_tag(v[i])) v[i] = NAN;
+  }
+}
+
+/* Push the values of a binary file */
+long load_binary(char *path, const char *data, size_t size) {
+  long n = size / sizeof(double);
+
+  if (size % sizeof(double) != 0) {
+    log_io_error("load", path, "the size is not a multiple of 8 bytes");
+    return -1;
+  }
+  if (!reserve_stack(n)) {
+    log_io_error("load", path, "not enough room in the stack");
+    return -1;
+  }
+
+  memcpy(&stack[sp], data, size);
+  little_endian_values(&stack[sp], n);
+  plain_values(&stack[sp], n);
+  memset(&stack_lo[sp], 0, n * sizeof(double));
+  sp += n;
+  return n;
+}
+
+/* Push the numbers of a text or CSV file, skipping the fields that
+   are not numbers (like the header of a CSV file). Every token is
+   copied before strtod() as the mapping is not terminated */
+long load_text(char *path, const char *data, size_t size, char *separators) {
+  char token[IO_MAX_TOKEN];
+  long n = 0, skipped = 0;
+  size_t i = 0;
+
+  while (i < size) {
+    while (i < size && strchr(separators, data[i])) i++;
+    size_t start = i;
+    while (i < size && !strchr(separators, data[i])) i++;
+    size_t length = i - start;
+    if (length == 0) break;
+
+    double value = 0;
+    int is_numeric = 0;
+    if (length < IO_MAX_TOKEN) {
+      memcpy(token, data + start, length);
+      token[length] = '\0';
+      set_input_if_numeric(token, &value, &is_numeric);
+    }
+    if (!is_numeric) {
+      skipped++;
+      continue;
+    }
+
+    if (!reserve_stack(1)) {
+      log_io_error("load", path, "not enough room in the stack");
+      return -1;
+    }
+    plain_values(&value, 1);
+    stack[sp] = value;
+    stack_lo[sp] = 0;
+    sp++;
+    n++;
+  }
+
+  if (skipped > 0) {
+    snprintf(operation_log[n_operation_log], sizeof(operation_log[0]),
+             "load %s: skipped %ld fields", path, skipped);
+    n_operation_log ++;
+  }
+  return n;
+}
+
+/* load FILE: push the values of a file */
+void compute_load(char *path) {
+  struct stat info;
+  long n = 0;
+  int fd = open(path, O_RDONLY);
+
+  if (fd < 0 || fstat(fd, &info) != 0) {
+    if (fd >= 0) close(fd);
+    log_io_error("load", path, strerror(errno));
+    return;
+  }
+
+  if (info.st_size > 0) {
+    char *data = mmap(NULL, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (data == MAP_FAILED) {
+      close(fd);
+      log_io_error("load", path, strerror(errno));
+      return;
+    }
+    madvise(data, info.st_size, MADV_SEQUENTIAL);
+
+    switch (file_format(path)) {
+    case 'b': n = load_binary(path, data, info.st_size); break;
+    case 'c': n = load_text(path, data, info.st_size, ", \t\r\n"); break;
+    default: n = load_text(path, data, info.st_size, " \t\r\n"); break;
+    }
+
+    munmap(data, info.st_size);
+  }
+  close(fd);
+
+  if (n >= 0) {
+    snprintf(operation_log[n_operation_log], sizeof(operation_log[0]),
+             "load %s: %ld values", path, n);
+    n_operation_log ++;
+  }
+}
+
+/* Write a whole buffer, retrying the partial writes */
+int write_all(int fd, const char *data, size_t size) {
+  while (size > 0) {
+    ssize_t written = write(fd, data, size);
+    if (written < 0) {
+      if (errno == EINTR) continue;
+      return 0;
+    }
+    data += written;
+    size -= written;
+  }
+  return 1;
+}
+
+/* Write the stack in binary, IO_BUFFER_SIZE bytes at a time
+   (converted to little-endian when needed) */
+int save_binary(int fd) {
+  static double buffer[IO_BUFFER_SIZE / sizeof(double)];
+  long per_write = IO_BUFFER_SIZE / sizeof(double);
+
+  for (long i = 0; i < sp; i += per_write) {
+    long n = (sp - i < per_write) ? sp - i : per_write;
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    memcpy(buffer, &stack[i], n * sizeof(double));
+    little_endian_values(buffer, n);
+    if (!write_all(fd, (char *)buffer, n * sizeof(double))) return 0;
+#else
+    (void)buffer;
+    if (!write_all(fd, (char *)&stack[i], n * sizeof(double))) return 0;
+#endif
+  }
+  return 1;
+}
+
+/* Write the stack as text, a value per line (a one column CSV),
+   with all the digits needed to read the same values back */
+int save_text(int fd) {
+  static char buffer[IO_BUFFER_SIZE];
+  size_t used = 0;
+
+  for (long i = 0; i < sp; i++) {
+    if (used > IO_BUFFER_SIZE - IO_MAX_TOKEN) {
+      if (!write_all(fd, buffer, used)) return 0;
+      used = 0;
+    }
+    used += snprintf(buffer + used, IO_MAX_TOKEN, "%.17g\n", stack[i]);
+  }
+  return write_all(fd, buffer, used);
+}
+
+/* save FILE: write the values of the stack, from the bottom to x.
+   Returns 0 if the file could not be written */
+int compute_save(char *path) {
+  int fd, ok;
+
+  if (refuse_lazy("save", 0)) return 0;
+
+  fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+  if (fd < 0) {
+    log_io_error("save", path, strerror(errno));
+    return 0;
+  }
+
+  ok = (file_format(path) == 'b') ? save_binary(fd) : save_text(fd);
+  if (close(fd) != 0) ok = 0;
+
+  if (!ok) {
+    log_io_error("save", path, strerror(errno));
+    return 0;
+  }
+  snprintf(operation_log[n_operation_log], sizeof(operation_log[0]),
+           "save %s: %d values", path, sp);
+  n_operation_log ++;
+  return 1;
+}
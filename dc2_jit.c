@@ -0,0 +1,352 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/* dc2.c -- Dave's (RPN) Calculator
+ *
+ * A simple RPN calculator for terminal
+ * made with love in Italy.
+ *
+ * Copyright 2025 Davide Mastromatteo
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation version 2 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+/* ----------------------------
+   EXPRESSION COMPILER
+   ---------------------------- */
+
+/* On x86-64 expression programs are compiled to SSE2 machine code:
+   a function double f(const double *variables) following the System V
+   calling convention. The evaluation stack lives in registers, slot i
+   in xmm(i + 1), so programs deeper than JIT_MAX_DEPTH are not compiled.
+   Arithmetic and square roots are single instructions, every other
+   operation is a call to the same C function the interpreter uses
+   (xmm registers do not survive calls, so the live slots are spilled
+   to the frame around it). rbx keeps the pointer to the variables.
+
+   The code is written into a read-write mapping that is made
+   executable, and never writable again, once complete. Compiled
+   functions are cached by program, which holds the operations chosen
+   by the modes, so a formula is compiled once.
+
+   map and the sequences evaluate the programs that are not compiled,
+   on other architectures all of them, with evaluate_expression_many().
+   So do they for the programs calling the fast functions, which run
+   faster on arrays than called one value at a time */
+
+#define JIT_MAX_DEPTH 14
+#define JIT_CACHE_SIZE 16
+
+/* enough for the longest program calling a function at every step */
+#define JIT_BUFFER_SIZE 32768
+
+typedef double (*jit_function)(const double *variables);
+
+typedef struct {
+  expr_program program;
+  void *code;
+  size_t size;
+  jit_function f;
+} jit_entry;
+
+jit_entry jit_cache[JIT_CACHE_SIZE];
+int jit_cache_next = 0;
+
+#if defined(__x86_64__) && (defined(__linux__) || defined(__APPLE__))
+
+typedef struct {
+  unsigned char *code;
+  size_t length;
+} jit_buffer;
+
+void emit(jit_buffer *b, int byte) {
+  b->code[b->length++] = (unsigned char)byte;
+}
+
+void emit_u32(jit_buffer *b, uint32_t value) {
+  for (int i = 0; i < 4; i++) emit(b, (value >> (8 * i)) & 0xff);
+}
+
+void emit_u64(jit_buffer *b, uint64_t value) {
+  emit_u32(b, (uint32_t)value);
+  emit_u32(b, (uint32_t)(value >> 32));
+}
+
+/* prefix [REX] 0F opcode with a register to register ModRM */
+void emit_sse(jit_buffer *b, int prefix, int opcode, int reg, int rm) {
+  emit(b, prefix);
+  if (reg >= 8 || rm >= 8) emit(b, 0x40 | ((reg >> 3) << 2) | (rm >> 3));
+  emit(b, 0x0f);
+  emit(b, opcode);
+  emit(b, 0xc0 | ((reg & 7) << 3) | (rm & 7));
+}
+
+/* prefix [REX] 0F opcode with a [base + disp8] operand, base being
+   rsp (with its SIB byte) or rbx */
+void emit_sse_memory(jit_buffer *b, int prefix, int opcode, int reg, int base, int disp) {
+  emit(b, prefix);
+  if (reg >= 8) emit(b, 0x44);
+  emit(b, 0x0f);
+  emit(b, opcode);
+  emit(b, 0x40 | ((reg & 7) << 3) | base);
+  if (base == 4) emit(b, 0x24);
+  emit(b, disp);
+}
+
+void emit_move(jit_buffer *b, int to, int from) {
+  if (to != from) emit_sse(b, 0x66, 0x28, to, from);        /* movapd */
+}
+
+/* Load a constant through rax */
+void emit_constant(jit_buffer *b, int reg, double value) {
+  emit(b, 0x48);                                             /* mov rax, imm64 */
+  emit(b, 0xb8);
+  emit_u64(b, double_to_bits(value));
+  emit(b, 0x66);                                             /* movq xmm, rax */
+  emit(b, 0x48 | ((reg >> 3) << 2));
+  emit(b, 0x0f);
+  emit(b, 0x6e);
+  emit(b, 0xc0 | ((reg & 7) << 3));
+}
+
+/* Save the slots below the operands of a call, before the operands
+   are moved into xmm0 and xmm1 */
+void emit_spill(jit_buffer *b, int live_slots) {
+  for (int i = 0; i < live_slots; i++) emit_sse_memory(b, 0xf2, 0x11, i + 1, 4, 8 * i);
+}
+
+/* Call a C function and restore the saved slots */
+void emit_call(jit_buffer *b, uint64_t address, int live_slots) {
+  emit(b, 0x48);                                             /* mov rax, imm64 */
+  emit(b, 0xb8);
+  emit_u64(b, address);
+  emit(b, 0xff);                                             /* call rax */
+  emit(b, 0xd0);
+  for (int i = 0; i < live_slots; i++) emit_sse_memory(b, 0xf2, 0x10, i + 1, 4, 8 * i);
+}
+
+uint64_t function_address_1o(operation_1o f) {
+  return (uint64_t)(uintptr_t)f;
+}
+
+uint64_t function_address_2o(operation_2o f) {
+  return (uint64_t)(uintptr_t)f;
+}
+
+/* Translate a program, returning 0 if it cannot be compiled */
+int jit_translate(expr_program *program, jit_buffer *b) {
+  int depth = 0;
+
+  if (program->max_depth > JIT_MAX_DEPTH) return 0;
+
+  emit(b, 0x53);                                             /* push rbx */
+  emit(b, 0x48);                                             /* mov rbx, rdi */
+  emit(b, 0x89);
+  emit(b, 0xfb);
+  emit(b, 0x48);                                             /* sub rsp, 128 */
+  emit(b, 0x81);
+  emit(b, 0xec);
+  emit_u32(b, 128);
+
+  for (int i = 0; i < program->length; i++) {
+    expr_instruction *in = &program->code[i];
+    int top = depth;   /* register of the top slot is top, of the new slot top + 1 */
+
+    switch (in->kind) {
+    case 'n':
+      emit_constant(b, top + 1, in->value);
+      depth++;
+      break;
+
+    case 'v':
+      emit_sse_memory(b, 0xf2, 0x10, top + 1, 3, 8 * in->variable);   /* movsd xmm, [rbx + d] */
+      depth++;
+      break;
+
+    case '1':
+      if (in->f1 == sqrt) {
+        emit_sse(b, 0xf2, 0x51, top, top);                   /* sqrtsd */
+      } else if (in->f1 == reciprocal) {
+        emit_constant(b, 15, 1.0);
+        emit_sse(b, 0xf2, 0x5e, 15, top);                    /* divsd */
+        emit_move(b, top, 15);
+      } else {
+        emit_spill(b, depth - 1);
+        emit_move(b, 0, top);
+        emit_call(b, function_address_1o(in->f1), depth - 1);
+        emit_move(b, top, 0);
+      }
+      break;
+
+    case 't':
+      /* in degrees through trigonometric_in_mode(f, x, 'd') */
+      emit_spill(b, depth - 1);
+      emit_move(b, 0, top);
+      if (in->angle_mode == 'd') {
+        emit(b, 0x48);                                       /* mov rdi, imm64 */
+        emit(b, 0xbf);
+        emit_u64(b, function_address_1o(in->f1));
+        emit(b, 0xbe);                                       /* mov esi, imm32 */
+        emit_u32(b, 'd');
+        emit_call(b, (uint64_t)(uintptr_t)trigonometric_in_mode, depth - 1);
+      } else {
+        emit_call(b, function_address_1o(in->f1), depth - 1);
+      }
+      emit_move(b, top, 0);
+      break;
+
+    case '2':
+      /* the result goes in the slot of y, the one below x */
+      if (in->f2 == sum) {
+        emit_sse(b, 0xf2, 0x58, top - 1, top);               /* addsd */
+      } else if (in->f2 == subtraction) {
+        emit_sse(b, 0xf2, 0x5c, top - 1, top);               /* subsd */
+      } else if (in->f2 == multiplication) {
+        emit_sse(b, 0xf2, 0x59, top - 1, top);               /* mulsd */
+      } else if (in->f2 == division) {
+        emit_sse(b, 0xf2, 0x5e, top - 1, top);               /* divsd */
+      } else {
+        emit_spill(b, depth - 2);
+        emit_move(b, 0, top);
+        emit_move(b, 1, top - 1);
+        emit_call(b, function_address_2o(in->f2), depth - 2);
+        emit_move(b, top - 1, 0);
+      }
+      depth--;
+      break;
+    }
+  }
+
+  emit_move(b, 0, 1);
+  emit(b, 0x48);                                             /* add rsp, 128 */
+  emit(b, 0x81);
+  emit(b, 0xc4);
+  emit_u32(b, 128);
+  emit(b, 0x5b);                                             /* pop rbx */
+  emit(b, 0xc3);                                             /* ret */
+
+  return 1;
+}
+
+/* Compile a program into executable memory */
+int jit_compile(expr_program *program, jit_entry *entry) {
+  jit_buffer b;
+  int ok;
+
+  b.code = malloc(JIT_BUFFER_SIZE);
+  b.length = 0;
+  if (b.code == NULL) return 0;
+
+  ok = jit_translate(program, &b);
+  if (ok) {
+    long page = sysconf(_SC_PAGESIZE);
+    entry->size = (b.length + page - 1) / page * page;
+    entry->code = mmap(NULL, entry->size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    ok = entry->code != MAP_FAILED;
+  }
+  if (ok) {
+    memcpy(entry->code, b.code, b.length);
+    ok = mprotect(entry->code, entry->size, PROT_READ | PROT_EXEC) == 0;
+    if (!ok) munmap(entry->code, entry->size);
+  }
+  if (ok) memcpy(&entry->f, &entry->code, sizeof(entry->f));
+
+  free(b.code);
+  return ok;
+}
+
+void jit_release(jit_entry *entry) {
+  munmap(entry->code, entry->size);
+}
+
+#else
+
+int jit_compile(expr_program *program, jit_entry *entry) {
+  (void)program;
+  (void)entry;
+  return 0;
+}
+
+void jit_release(jit_entry *entry) {
+  (void)entry;
+}
+
+#endif
+
+/* Check if two programs do the same operations */
+int same_program(expr_program *a, expr_program *b) {
+  if (a->length != b->length) return 0;
+
+  for (int i = 0; i < a->length; i++) {
+    expr_instruction *p = &a->code[i], *q = &b->code[i];
+    if (p->kind != q->kind) return 0;
+    if (p->kind == 'n' && double_to_bits(p->value) != double_to_bits(q->value)) return 0;
+    if (p->kind == 'v' && p->variable != q->variable) return 0;
+    if ((p->kind == '1' || p->kind == 't') && p->f1 != q->f1) return 0;
+    if (p->kind == 't' && p->angle_mode != q->angle_mode) return 0;
+    if (p->kind == '2' && p->f2 != q->f2) return 0;
+  }
+  return 1;
+}
+
+/* Get the compiled function of a program, compiling it on a
+   cache miss. Returns NULL if it must be interpreted */
+jit_function get_compiled_expression(expr_program *program) {
+  for (int i = 0; i < JIT_CACHE_SIZE; i++) {
+    if (jit_cache[i].f && same_program(&jit_cache[i].program, program)) return jit_cache[i].f;
+  }
+
+  jit_entry *entry = &jit_cache[jit_cache_next];
+  if (entry->f) {
+    jit_release(entry);
+    entry->f = NULL;
+  }
+  if (!jit_compile(program, entry)) return NULL;
+
+  entry->program = *program;
+  jit_cache_next = (jit_cache_next + 1) % JIT_CACHE_SIZE;
+  return entry->f;
+}
+
+/* Get the compiled function of a program of x, or NULL if it is to
+   be evaluated in bulk: when it uses an operation with a bulk version,
+   or when it cannot be compiled */
+jit_function get_map_function(expr_program *program) {
+  if (has_bulk_operations(program)) return NULL;
+  return get_compiled_expression(program);
+}
+
+/* map <expression>: replace every value of the stack with the value
+   of the expression, the value being x */
+void compute_map(char *expression) {
+  expr_program program;
+  jit_function f;
+
+  if (refuse_lazy("map", 0)) return;
+  if (!parse_expression("map", expression, &program)) return;
+  if (program.n_variables > 1) {
+    log_expression_error("map", "only x can be used in", expression);
+    return;
+  }
+
+  f = get_map_function(&program);
+  if (f) {
+    for (int i = 0; i < sp; i++) stack[i] = f(&stack[i]);
+  } else {
+    evaluate_expression_many(&program, stack, sp);
+  }
+  memset(stack_lo, 0, sp * sizeof(double));
+
+  snprintf(operation_log[n_operation_log], sizeof(operation_log[0]),
+           "map %s on %d values%s", expression, sp, f ? "" : " (in bulk)");
+  n_operation_log ++;
+}
@@ -0,0 +1,420 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/* dc2.c -- Dave's (RPN) Calculator
+ *
+ * A simple RPN calculator for terminal
+ * made with love in Italy.
+ *
+ * Copyright 2025 Davide Mastromatteo
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation version 2 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+/* ----------------
+   LAZY SEQUENCES
+   ---------------- */
+
+/* A sequence (range, linspace, geom, rndseq) takes a single stack
+   entry: a NaN whose payload is the index of its description in a
+   table. The description is a generator and a program in x, made of
+   the operations applied to the sequence so far, so "2 *" on a
+   sequence only appends "2 *" to its program. The operations are
+   chosen, and their angle mode recorded, when they are applied: a
+   later change of mode does not change the values of a sequence.
+
+   Values are produced only by a reduction or by eval, LAZY_CHUNK at a
+   time: the generator fills the chunk, the program (compiled, or run in
+   bulk) is applied in place and the chunk is consumed while still
+   in cache. Memory use does not depend on the length.
+
+   Descriptions are never modified, an operation makes a new one, so
+   copies of an entry on the stack stay independent. When the table is
+   full the descriptions no longer referenced by the stack are reused */
+
+#define LAZY_MAX_SEQUENCES 64
+#define LAZY_CHUNK 1024
+#define LAZY_TAG 0x7ff8dc2000000000ULL
+#define LAZY_TAG_MASK 0xffffffffffff0000ULL
+
+typedef struct {
+  char kind;          /* r = range, l = linspace, g = geometric,
+                         u = uniform random, 0 = free */
+  double start;
+  double step;        /* the ratio for geometric sequences */
+  double end;
+  long length;
+  random_lanes random;
+  expr_program program;
+} lazy_sequence;
+
+typedef struct {
+  lazy_sequence *sequence;
+  long position;
+  random_lanes random;
+  jit_function f;
+} lazy_reader;
+
+lazy_sequence lazy_sequences[LAZY_MAX_SEQUENCES];
+
+/* A NaN carrying the tag, that may or may not be a sequence */
+int has_lazy_tag(double value) {
+  return (double_to_bits(value) & LAZY_TAG_MASK) == LAZY_TAG;
+}
+
+/* A sequence is a tagged NaN whose index is a description in use */
+int is_lazy(double value) {
+  uint64_t index = double_to_bits(value) & ~LAZY_TAG_MASK;
+  return has_lazy_tag(value) && index < LAZY_MAX_SEQUENCES && lazy_sequences[index].kind != 0;
+}
+
+lazy_sequence *get_lazy(double value) {
+  return &lazy_sequences[double_to_bits(value) & ~LAZY_TAG_MASK];
+}
+
+/* The commands working on many values at once do not know about
+   sequences, and the NaN of a sequence would carry its tag into
+   their results. Returns 1 (logging why) if there is a sequence
+   among the entries from position from to x */
+int refuse_lazy(char *name, long from) {
+  for (long i = from; i < sp; i++) {
+    if (is_lazy(stack[i])) {
+      sprintf(operation_log[n_operation_log], "%s: expand the sequences with eval first", name);
+      n_operation_log ++;
+      return 1;
+    }
+  }
+  return 0;
+}
+
+/* Describe a sequence in the width of a stack cell */
+void describe_lazy(double value, char *text, int size) {
+  lazy_sequence *s = get_lazy(value);
+  char *name = "range";
+
+  if (s->kind == 'l') name = "linspace";
+  if (s->kind == 'g') name = "geom";
+  if (s->kind == 'u') name = "rndseq";
+
+  snprintf(text, size, "%s[%ld]%s", name, s->length,
+           s->program.length == 1 ? "" : " f(x)");
+}
+
+/* Get a free description, reusing the ones no longer on the stack */
+lazy_sequence *new_lazy(void) {
+  int referenced[LAZY_MAX_SEQUENCES] = { 0 };
+
+  for (int round = 0; round < 2; round++) {
+    for (int i = 0; i < LAZY_MAX_SEQUENCES; i++) {
+      if (lazy_sequences[i].kind == 0) return &lazy_sequences[i];
+    }
+
+    for (int i = 0; i < sp; i++) {
+      if (is_lazy(stack[i])) referenced[get_lazy(stack[i]) - lazy_sequences] = 1;
+    }
+    for (int i = 0; i < LAZY_MAX_SEQUENCES; i++) {
+      if (!referenced[i]) lazy_sequences[i].kind = 0;
+    }
+  }
+
+  sprintf(operation_log[n_operation_log], "too many sequences on the stack");
+  n_operation_log ++;
+  return NULL;
+}
+
+void push_lazy(lazy_sequence *s) {
+  push(bits_to_double(LAZY_TAG | (uint64_t)(s - lazy_sequences)));
+}
+
+/* Start reading a sequence */
+void lazy_open(lazy_reader *r, lazy_sequence *s) {
+  r->sequence = s;
+  r->position = 0;
+  r->random = s->random;
+  r->f = (s->program.length > 1) ? get_map_function(&s->program) : NULL;
+}
+
+/* Read the next values of a sequence into v (LAZY_CHUNK at most),
+   returning how many were read: 0 at the end */
+long lazy_read(lazy_reader *r, double *v) {
+  lazy_sequence *s = r->sequence;
+  long first = r->position;
+  long n = s->length - first;
+
+  if (n > LAZY_CHUNK) n = LAZY_CHUNK;
+  if (n <= 0) return 0;
+
+  switch (s->kind) {
+  case 'r':
+  case 'l':
+    for (long i = 0; i < n; i++) v[i] = s->start + (double)(first + i) * s->step;
+    /* the last value of a linspace is exactly the end */
+    if (s->kind == 'l' && first + n == s->length) v[n - 1] = s->end;
+    break;
+  case 'g':
+    /* the powers are computed again at every chunk to limit the rounding */
+    v[0] = s->start * pow(s->step, (double)first);
+    for (long i = 1; i < n; i++) v[i] = v[i - 1] * s->step;
+    break;
+  case 'u':
+    random_fill_uniform(&r->random, v, n);
+    break;
+  }
+
+  if (r->f) {
+    for (long i = 0; i < n; i++) v[i] = r->f(&v[i]);
+  } else if (s->program.length > 1) {
+    evaluate_expression_many(&s->program, v, n);
+  }
+
+  r->position += n;
+  return n;
+}
+
+/* Make a sequence from a generator, checking its length */
+void make_lazy(char kind, double start, double step, double end, double length, char *name) {
+  lazy_sequence *s;
+
+  if (!(length >= 1 && length <= 9007199254740992.0)) {
+    sprintf(operation_log[n_operation_log], "%s: the sequence would have %lg values", name, length);
+    n_operation_log ++;
+    return;
+  }
+  if ((s = new_lazy()) == NULL) return;
+
+  s->kind = kind;
+  s->start = start;
+  s->step = step;
+  s->end = end;
+  s->length = (long)length;
+  memset(&s->program, 0, sizeof(s->program));
+  s->program.code[0].kind = 'v';
+  s->program.length = 1;
+  s->program.n_variables = 1;
+  s->program.max_depth = 1;
+  if (kind == 'u') {
+    /* every random sequence gets its own stream, and gives the
+       same values every time it is read */
+    random_state stream = random_generator;
+    random_jump(&random_generator);
+    for (int i = 0; i < RANDOM_LANES; i++) {
+      random_jump(&stream);
+      for (int k = 0; k < 4; k++) s->random.s[k][i] = stream.s[k];
+    }
+  }
+  push_lazy(s);
+
+  sprintf(operation_log[n_operation_log], "%s of %ld values", name, s->length);
+  n_operation_log ++;
+}
+
+/* y x range: the numbers y, y + 1, ... up to x */
+void range_operation(void) {
+  if (sp < 2) return;
+  double b = pop();
+  double a = pop();
+  make_lazy('r', a, 1, b, floor(b - a) + 1, "range");
+}
+
+/* z y x linspace: x numbers evenly spaced from z to y */
+void linspace_operation(void) {
+  if (sp < 3) return;
+  double n = floor(pop());
+  double b = pop();
+  double a = pop();
+  make_lazy('l', a, n > 1 ? (b - a) / (n - 1) : 0, b, n, "linspace");
+}
+
+/* z y x geom: the x numbers z, z y, z y^2 ... */
+void geom_operation(void) {
+  if (sp < 3) return;
+  double n = floor(pop());
+  double r = pop();
+  double a = pop();
+  make_lazy('g', a, r, 0, n, "geom");
+}
+
+/* x rndseq: x uniform random numbers in [0, 1) */
+void rndseq_operation(void) {
+  if (sp < 1) return;
+  double n = floor(pop());
+  make_lazy('u', 0, 0, 0, n, "rndseq");
+}
+
+/* Apply an operation to the sequences among its operands, making
+   it part of their program. Returns 1 if the command was used */
+int compute_lazy_operation(char *command) {
+  lazy_sequence *s, *result;
+  expr_program program;
+  expr_instruction operation = { 0 }, constant = { 0 };
+  double x, y = 0;
+  int operands;
+
+  if (sp < 1) return 0;
+  x = pick(sp);
+  if (sp >= 2) y = pick(sp - 1);
+
+  if ((operation.f2 = get_operation_2o(command))) {
+    if (sp < 2 || !(is_lazy(x) || is_lazy(y))) return 0;
+    operands = 2;
+    operation.kind = '2';
+    if (is_lazy(x) && is_lazy(y)) {
+      sprintf(operation_log[n_operation_log], "%s: cannot combine two sequences", command);
+      n_operation_log ++;
+      return 1;
+    }
+  } else if ((operation.f1 = get_operation_1o(command))) {
+    if (!is_lazy(x)) return 0;
+    operands = 1;
+    operation.kind = '1';
+  } else if ((operation.f1 = get_trigonometric_operation_1o(command))) {
+    if (!is_lazy(x)) return 0;
+    operands = 1;
+    operation.kind = 't';
+    operation.angle_mode = mode;
+  } else {
+    return 0;
+  }
+
+  /* the values of a sequence are doubles, there is no exact
+     result to keep for each of them */
+  if (operation.f1 == exact_factorial) operation.f1 = factorial;
+  if (operation.f2 == exact_to_power) operation.f2 = to_power;
+
+  s = get_lazy(is_lazy(x) ? x : y);
+  if (s->program.length + operands > EXPR_MAX_LENGTH) {
+    sprintf(operation_log[n_operation_log], "%s: the sequence expression is too long", command);
+    n_operation_log ++;
+    return 1;
+  }
+
+  /* the operation is f(x, y): the constant goes before the
+     program when it was below the sequence on the stack */
+  program = s->program;
+  if (operands == 2) {
+    constant.kind = 'n';
+    constant.value = is_lazy(x) ? y : x;
+    if (is_lazy(x)) {
+      memmove(&program.code[1], &program.code[0], program.length * sizeof(expr_instruction));
+      program.code[0] = constant;
+      program.max_depth++;
+    } else {
+      program.code[program.length] = constant;
+      if (program.max_depth < 2) program.max_depth = 2;
+    }
+    program.length++;
+  }
+  program.code[program.length++] = operation;
+
+  if ((result = new_lazy()) == NULL) return 1;
+
+  *result = *s;
+  result->program = program;
+  sp -= operands;
+  push_lazy(result);
+  return 1;
+}
+
+/* Pop a sequence and open it for reading, logging why on error */
+int pop_lazy(char *name, lazy_reader *r) {
+  if (sp < 1) return 0;
+  if (!is_lazy(pick(sp))) {
+    sprintf(operation_log[n_operation_log], "%s: x is not a sequence", name);
+    n_operation_log ++;
+    return 0;
+  }
+  lazy_open(r, get_lazy(pick(sp)));
+  pop();
+  return 1;
+}
+
+/* Reduce a sequence to its sum, product, minimum and maximum in a
+   single pass. The chunks are summed with four accumulators, and the
+   sums of the chunks are added with Neumaier's compensation */
+void lazy_reduce(char *name, char which) {
+  lazy_reader r;
+  double v[LAZY_CHUNK];
+  double sum = 0, compensation = 0, product = 1;
+  double minimum = INFINITY, maximum = -INFINITY;
+  long n, count = 0;
+
+  if (!pop_lazy(name, &r)) return;
+
+  while ((n = lazy_read(&r, v)) > 0) {
+    double partial[4] = { 0, 0, 0, 0 };
+    long i = 0;
+    for (; i + 4 <= n; i += 4) {
+      for (int l = 0; l < 4; l++) partial[l] += v[i + l];
+    }
+    for (; i < n; i++) partial[0] += v[i];
+    double chunk = (partial[0] + partial[1]) + (partial[2] + partial[3]);
+
+    double t = sum + chunk;
+    compensation += (fabs(sum) >= fabs(chunk)) ? (sum - t) + chunk : (chunk - t) + sum;
+    sum = t;
+
+    if (which == 'p') for (i = 0; i < n; i++) product *= v[i];
+    if (which == 'n') for (i = 0; i < n; i++) minimum = v[i] < minimum ? v[i] : minimum;
+    if (which == 'x') for (i = 0; i < n; i++) maximum = v[i] > maximum ? v[i] : maximum;
+    count += n;
+  }
+
+  double result = sum + compensation;
+  if (which == 'm') result /= count;
+  if (which == 'p') result = product;
+  if (which == 'n') result = minimum;
+  if (which == 'x') result = maximum;
+  push(result);
+
+  sprintf(operation_log[n_operation_log], "%s of %ld values = %lg", name, count, result);
+  n_operation_log ++;
+}
+
+void sumx_operation(void) {
+  lazy_reduce("sumx", 's');
+}
+
+void prodx_operation(void) {
+  lazy_reduce("prodx", 'p');
+}
+
+void meanx_operation(void) {
+  lazy_reduce("meanx", 'm');
+}
+
+void minx_operation(void) {
+  lazy_reduce("minx", 'n');
+}
+
+void maxx_operation(void) {
+  lazy_reduce("maxx", 'x');
+}
+
+/* Replace a sequence with its values */
+void eval_operation(void) {
+  lazy_reader r;
+
+  if (sp < 1 || !is_lazy(pick(sp))) return;
+  if (!reserve_stack(get_lazy(pick(sp))->length)) {
+    sprintf(operation_log[n_operation_log], "eval: not enough room in the stack");
+    n_operation_log ++;
+    return;
+  }
+  if (!pop_lazy("eval", &r)) return;
+
+  /* the room was checked, the chunks can be read in place */
+  long n;
+  while ((n = lazy_read(&r, &stack[sp])) > 0) {
+    memset(&stack_lo[sp], 0, n * sizeof(double));
+    sp += n;
+  }
+}
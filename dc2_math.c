@@ -40,6 +40,7 @@ void log_operation_1o(double x, char *name, double r) {
 typedef void (*operation_0o)(void);
 typedef double (*operation_1o)(double);
 typedef double (*operation_2o)(double, double);
+typedef void (*operation_many)(double *, long);
 
 /* Compute a single operand operation */
 void compute_operation_0o(operation_0o f) {
@@ -55,11 +56,55 @@ void compute_operation_1o(operation_1o f, char *name) {
   log_operation_1o(x, name, r);
 }
 
+/* Get the version of a trigonometric operation taking degrees */
+operation_1o get_degrees_operation_1o(operation_1o f) {
+  if (f == sin) return sin_degrees;
+  if (f == cos) return cos_degrees;
+  if (f == tan) return tan_degrees;
+  if (f == fast_sin) return fast_sin_degrees;
+  if (f == fast_cos) return fast_cos_degrees;
+  if (f == fast_tan) return fast_tan_degrees;
+  return NULL;
+}
+
+/* Get the version of an operation working on an array in place,
+   NULL if it has none */
+operation_many get_bulk_operation_1o(operation_1o f) {
+  if (f == fast_exp) return fast_exp_many;
+  if (f == fast_log) return fast_log_many;
+  if (f == fast_log10) return fast_log10_many;
+  if (f == fast_atan) return fast_atan_many;
+  if (f == fast_sin) return fast_sin_many;
+  if (f == fast_cos) return fast_cos_many;
+  if (f == fast_tan) return fast_tan_many;
+  return NULL;
+}
+
+/* Check if an operation is an inverse trigonometric function,
+   returning an angle instead of taking one */
+int is_inverse_trigonometric(operation_1o f) {
+  return f == asin || f == acos || f == atan || f == fast_atan;
+}
+
+/* Compute a trigonometric function in the given angle mode */
+double trigonometric_in_mode(operation_1o f, double x, char angle_mode) {
+  if (angle_mode != 'd') return f(x);
+  if (is_inverse_trigonometric(f)) return f(x) * 180 / M_PI;
+
+  operation_1o degrees = get_degrees_operation_1o(f);
+  if (degrees) return degrees(x);
+  return f(x * M_PI / 180);
+}
+
+/* Compute a trigonometric function honouring the angle mode */
+double trigonometric(operation_1o f, double x) {
+  return trigonometric_in_mode(f, x, mode);
+}
+
 void compute_trigonometric_operation_1o(operation_1o f, char *name) {
   if (sp < 1) return;
   double x = pop();
-  if (mode == 'd') x = x * M_PI / 180;
-  double r = f(x);
+  double r = trigonometric(f, x);
   push(r);
   log_operation_1o(x, name, r);
 }
@@ -74,6 +119,151 @@ void compute_operation_2o(operation_2o f, char *name) {
   log_operation_2o(y, x, name, r);
 }
 
+/* Compute a double-double single operand operation */
+void compute_dd_operation_1o(dd_operation_1o f, char *name) {
+  if (sp < 1) return;
+  dd x = pop_dd();
+  dd r = f(x);
+  push_dd(r);
+  log_operation_1o(x.hi, name, r.hi);
+}
+
+/* Compute sin, cos or tan of an angle in degrees reducing it
+   exactly, so that multiples of 90 degrees give exact results */
+dd dd_trigonometric_degrees(dd_operation_1o f, dd x) {
+  double r;
+  int q = reduce_degrees(x.hi, &r);
+  dd radians = dd_mul(two_sum(r, x.lo), DD_PI_180);
+  dd sr = dd_sin_taylor(radians);
+  dd cr = dd_cos_taylor(radians);
+  dd sin_values[4] = { sr, cr, dd_neg(sr), dd_neg(cr) };
+  dd cos_values[4] = { cr, dd_neg(sr), dd_neg(cr), sr };
+  dd s = sin_values[q];
+  dd c = cos_values[q];
+  s.hi += 0.0;
+  c.hi += 0.0;
+  if (f == dd_sin) return s;
+  if (f == dd_cos) return c;
+  return dd_div(s, c);
+}
+
+void compute_dd_trigonometric_operation_1o(dd_operation_1o f, char *name) {
+  if (sp < 1) return;
+  dd x = pop_dd();
+  dd r;
+  if (mode == 'd' && (f == dd_sin || f == dd_cos || f == dd_tan)) {
+    r = dd_trigonometric_degrees(f, x);
+  } else if (mode == 'd') {
+    r = dd_div(f(x), DD_PI_180);
+  } else {
+    r = f(x);
+  }
+  push_dd(r);
+  log_operation_1o(x.hi, name, r.hi);
+}
+
+/* Replace x with its sine and cosine, computed together */
+void sincos_operation(void) {
+  if (sp < 1 || refuse_lazy("sincos", sp - 1)) return;
+
+  if (arithmetic_mode == 'd') {
+    dd x = pop_dd();
+    dd s = (mode == 'd') ? dd_trigonometric_degrees(dd_sin, x) : dd_sin(x);
+    dd c = (mode == 'd') ? dd_trigonometric_degrees(dd_cos, x) : dd_cos(x);
+    push_dd(s);
+    push_dd(c);
+    sprintf(operation_log[n_operation_log], "%lg sincos = %lg %lg", x.hi, s.hi, c.hi);
+    n_operation_log ++;
+    return;
+  }
+
+  double x = pop();
+  double s, c;
+  if (mode == 'd') {
+    sincos_degrees(x, &s, &c, precision == 'f');
+  } else if (precision == 'f') {
+    fast_sincos(x, &s, &c);
+  } else {
+    s = sin(x);
+    c = cos(x);
+  }
+  push(s);
+  push(c);
+  sprintf(operation_log[n_operation_log], "%lg sincos = %lg %lg", x, s, c);
+  n_operation_log ++;
+}
+
+/* Replace x with x uniform random numbers in [0, 1),
+   generated in bulk directly into the stack */
+void random_numbers_operation(void) {
+  if (sp < 1) return;
+
+  double n = pop();
+  /* checked before the conversion, as counts beyond a long
+     (and NaN) have no value as one */
+  if (!(n <= STACK_MAX_LENGTH)) {
+    push(n);
+    sprintf(operation_log[n_operation_log], "rndn: %lg numbers would not fit in the stack", n);
+    n_operation_log ++;
+    return;
+  }
+  long count = (long)fmax(n, 0);
+  if (!reserve_stack(count)) {
+    push(n);
+    sprintf(operation_log[n_operation_log], "rndn: not enough room in the stack");
+    n_operation_log ++;
+    return;
+  }
+  random_fill_uniform(&random_bulk_generator, &stack[sp], count);
+  memset(&stack_lo[sp], 0, count * sizeof(double));
+  sp += count;
+
+  sprintf(operation_log[n_operation_log], "%lg rndn = %ld numbers", n, count);
+  n_operation_log ++;
+}
+
+/* Push a standard normal random number */
+void random_normal_operation(void) {
+  push(random_normal(&random_generator));
+}
+
+/* Push an exponential random number of rate 1 */
+void random_exponential_operation(void) {
+  push(random_exponential(&random_generator));
+}
+
+/* Replace y and x with a random integer in [y, x] */
+void random_integer_operation(void) {
+  if (sp < 2) return;
+
+  double b = pop();
+  double a = pop();
+  if (a != floor(a) || b != floor(b) || a > b ||
+      fabs(a) > 9007199254740992.0 || fabs(b) > 9007199254740992.0) {
+    push(a);
+    push(b);
+    sprintf(operation_log[n_operation_log], "rndint: %lg %lg is not an integer range", a, b);
+    n_operation_log ++;
+    return;
+  }
+
+  uint64_t range = (uint64_t)(int64_t)b - (uint64_t)(int64_t)a + 1;
+  double r = (double)((int64_t)a + (int64_t)random_bounded(&random_generator, range));
+  push(r);
+  sprintf(operation_log[n_operation_log], "%lg %lg rndint = %lg", a, b, r);
+  n_operation_log ++;
+}
+
+/* Compute a double-double two-operands operation */
+void compute_dd_operation_2o(dd_operation_2o f, char *name) {
+  if (sp < 2) return;
+  dd y = pop_dd();
+  dd x = pop_dd();
+  dd r = f(y, x);
+  push_dd(r);
+  log_operation_2o(y.hi, x.hi, name, r.hi);
+}
+
 /* Compute the power x of y */
 double to_power(double x, double y) {
   return pow(y, x);
@@ -110,3 +300,75 @@ double reciprocal(double x) {
 }
 
 
+/* Check if a number is a non negative integer small enough
+   to be handled exactly */
+int is_exact_integer(double x) {
+  return x >= 0 && x <= 9007199254740992.0 && x == floor(x);
+}
+
+/* Compute the factorial of a number exactly,
+   keeping all the digits in the last exact result */
+double exact_factorial(double x) {
+  if (!is_exact_integer(x)) return factorial(x);
+  if (lgamma(x + 1) / M_LN10 > EXACT_MAX_DIGITS) return factorial(x);
+
+  bignum r = bignum_factorial((uint64_t)x);
+  set_last_exact(&r);
+  return bignum_to_double(&last_exact);
+}
+
+/* Compute the power x of y exactly when both are integers,
+   keeping all the digits in the last exact result */
+double exact_to_power(double x, double y) {
+  if (!is_exact_integer(x) || !is_exact_integer(fabs(y))) return to_power(x, y);
+  if (y != 0 && x * log10(fabs(y)) > EXACT_MAX_DIGITS) return to_power(x, y);
+
+  bignum base = bignum_from_u64((uint64_t)fabs(y));
+  bignum r = bignum_power(&base, (uint64_t)x);
+  r.negative = (y < 0) && ((uint64_t)x & 1) && r.len > 0;
+  bignum_free(&base);
+  set_last_exact(&r);
+  return bignum_to_double(&last_exact);
+}
+
+/* Compute the digamma function, the derivative of log(gamma(x)) */
+double digamma(double x) {
+  double result = 0;
+
+  if (x <= 0 && x == floor(x)) return NAN;
+  if (x < 0) return digamma(1 - x) - M_PI / tan(M_PI * x);
+
+  /* move x where the asymptotic series is accurate: from 12 on, the
+     first term left out is below 1e-17 */
+  while (x < 12) {
+    result -= 1 / x;
+    x += 1;
+  }
+
+  double f = 1 / (x * x);
+  return result + log(x) - 0.5 / x
+         - f * (1.0/12 - f * (1.0/120 - f * (1.0/252 - f * (1.0/240
+         - f * (1.0/132 - f * (691.0/32760 - f * (1.0/12)))))));
+}
+
+/* Compute the trigamma function, the derivative of digamma(x) */
+double trigamma(double x) {
+  double result = 0;
+
+  if (x <= 0 && x == floor(x)) return NAN;
+  if (x < 0) {
+    double s = sin(M_PI * x);
+    return -trigamma(1 - x) + M_PI * M_PI / (s * s);
+  }
+
+  while (x < 12) {
+    result += 1 / (x * x);
+    x += 1;
+  }
+
+  double f = 1 / (x * x);
+  return result + 1 / x + f / 2
+         + f / x * (1.0/6 - f * (1.0/30 - f * (1.0/42 - f * (1.0/30
+         - f * (5.0/66 - f * (691.0/2730 - f * (7.0/6)))))));
+}
+
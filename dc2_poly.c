@@ -0,0 +1,474 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/* dc2.c -- Dave's (RPN) Calculator
+ *
+ * A simple RPN calculator for terminal
+ * made with love in Italy.
+ *
+ * Copyright 2025 Davide Mastromatteo
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation version 2 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+/* ----------------
+   POLYNOMIALS
+   ---------------- */
+
+/* A polynomial of degree n is made of n + 1 entries of the stack, the
+   coefficient of the highest power at the bottom, so that 3x² + 2x + 1
+   is typed as 3 2 1. The degree goes in x, as the length of a signal.
+
+   Evaluation uses Horner's scheme, one fused multiply-add per
+   coefficient. The evaluation loops are built twice, with and without
+   the FMA instructions of x86-64, and the one for the machine is
+   picked when dc2 starts; elsewhere fma() is left to the compiler and
+   the C library. Results are the same on every machine.
+
+   From POLY_ESTRIN_DEGREE on the evaluation of a single value uses
+   Estrin's scheme, which multiplies pairs of coefficients by x, x²,
+   x⁴, ... so that the steps of a level do not wait for each other.
+   Many values are evaluated POLY_LANES at a time, each step of Horner
+   being the same on all of them.
+
+   Roots are found with the Aberth-Ehrlich iteration, which refines all
+   of them at once, each one until its step stalls at the rounding error
+   of z or is lost in the rounding errors of p(z). The complex roots of
+   a real polynomial are then paired with their conjugates.
+
+   Fits are least squares solved with a QR factorization built one
+   point at a time by Givens rotations, so that the Vandermonde matrix
+   is never stored */
+
+#define POLY_LANES 4
+#define POLY_ESTRIN_DEGREE 128
+#define POLY_MAX_ITERATIONS 500
+
+#define POLY_FMA(a, b, c) fma(a, b, c)
+
+#if defined(__GNUC__) && defined(__x86_64__) && !defined(FP_FAST_FMA)
+#define POLY_TARGET __attribute__((target_clones("fma", "default")))
+#else
+#define POLY_TARGET
+#endif
+
+/* Evaluate a[0] x^n + ... + a[n] with Horner's scheme */
+POLY_TARGET double poly_horner(const double *a, long n, double x) {
+  double r = a[0];
+  for (long k = 1; k <= n; k++) r = POLY_FMA(r, x, a[k]);
+  return r;
+}
+
+/* Evaluate a[0] x^n + ... + a[n] with Estrin's scheme: every level
+   halves the number of terms, b[i] = b[2i] x^(2^level) + b[2i + 1],
+   counting from the constant term. Falls back to Horner if there is
+   not enough memory for the terms */
+POLY_TARGET double poly_estrin(const double *a, long n, double x) {
+  long terms = n + 1;
+  double *b = malloc(terms * sizeof(double));
+
+  if (b == NULL) return poly_horner(a, n, x);
+
+  /* b[i] is the coefficient of x^i */
+  for (long i = 0; i < terms; i++) b[i] = a[n - i];
+
+  while (terms > 1) {
+    long half = terms / 2;
+    for (long i = 0; i < half; i++) b[i] = POLY_FMA(b[2 * i + 1], x, b[2 * i]);
+    if (terms % 2) b[half++] = b[terms - 1];
+    terms = half;
+    x *= x;
+  }
+
+  double r = b[0];
+  free(b);
+  return r;
+}
+
+double poly_evaluate(const double *a, long n, double x) {
+  return (n < POLY_ESTRIN_DEGREE) ? poly_horner(a, n, x) : poly_estrin(a, n, x);
+}
+
+/* Replace every value of v with the polynomial at that value */
+POLY_TARGET void poly_evaluate_many(const double *a, long n, double *v, long m) {
+  long i = 0;
+
+  for (; i + POLY_LANES <= m; i += POLY_LANES) {
+    double x[POLY_LANES], r[POLY_LANES];
+    for (int l = 0; l < POLY_LANES; l++) {
+      x[l] = v[i + l];
+      r[l] = a[0];
+    }
+    for (long k = 1; k <= n; k++) {
+      for (int l = 0; l < POLY_LANES; l++) r[l] = POLY_FMA(r[l], x[l], a[k]);
+    }
+    for (int l = 0; l < POLY_LANES; l++) v[i + l] = r[l];
+  }
+  for (; i < m; i++) v[i] = poly_horner(a, n, v[i]);
+}
+
+/* Evaluate the polynomial and its derivative at z. For |z| > 1 the
+   polynomial is evaluated in 1 / z, reversed, so that the powers of
+   z cannot overflow. Returns the Newton correction p(z) / p'(z), and
+   in noise |p(z)| over the bound of the rounding errors of its
+   evaluation: z is a root as good as any when noise <= 1 */
+double complex poly_newton_correction(const double *a, long n, double complex z, double *noise) {
+  double complex p, dp;
+  double bound;
+
+  if (cabs(z) <= 1) {
+    double r = cabs(z);
+    p = a[0];
+    dp = 0;
+    bound = fabs(a[0]);
+    for (long k = 1; k <= n; k++) {
+      dp = dp * z + p;
+      p = p * z + a[k];
+      bound = bound * r + fabs(a[k]);
+    }
+    *noise = cabs(p) / (4 * n * DBL_EPSILON * bound);
+    return p / dp;
+  }
+
+  /* p(z) = z^n q(w) and p'(z) = z^(n-1) (n q(w) - w q'(w)), w = 1 / z */
+  double complex w = 1 / z;
+  double r = cabs(w);
+  p = a[n];
+  dp = 0;
+  bound = fabs(a[n]);
+  for (long k = n - 1; k >= 0; k--) {
+    dp = dp * w + p;
+    p = p * w + a[k];
+    bound = bound * r + fabs(a[k]);
+  }
+  *noise = cabs(p) / (4 * n * DBL_EPSILON * bound);
+  return 1 / (w * (n - w * dp / p));
+}
+
+int compare_roots(const void *a, const void *b) {
+  double complex x = *(const double complex *)a, y = *(const double complex *)b;
+  if (creal(x) != creal(y)) return (creal(x) < creal(y)) ? -1 : 1;
+  if (cimag(x) != cimag(y)) return (cimag(x) < cimag(y)) ? -1 : 1;
+  return 0;
+}
+
+/* Sort the roots by imaginary part, the largest first */
+int compare_imaginary_parts(const void *a, const void *b) {
+  double x = cimag(*(const double complex *)a), y = cimag(*(const double complex *)b);
+  return (x > y) ? -1 : (x < y);
+}
+
+/* Find the n roots of a[0] x^n + ... + a[n], a[0] not being zero.
+   Returns 0 if the iteration does not converge */
+int poly_roots(const double *a, long n, double complex *z) {
+  int *converged;
+  double *least_noise;
+  double complex *best;
+  long found = 0, degree = n;
+
+  /* the zero roots are exact */
+  while (n > 0 && a[n] == 0) {
+    z[--n] = 0;
+  }
+  if (n == 0) return 1;
+
+  converged = calloc(n, sizeof(int));
+  least_noise = malloc(n * sizeof(double));
+  best = malloc(n * sizeof(double complex));
+  if (converged == NULL || least_noise == NULL || best == NULL) {
+    free(converged);
+    free(least_noise);
+    free(best);
+    return 0;
+  }
+  for (long i = 0; i < n; i++) least_noise[i] = INFINITY;
+
+  /* start on a circle with the radius of the geometric mean of the
+     roots, the angle offset breaking the symmetry of real polynomials */
+  double radius = pow(fabs(a[n] / a[0]), 1.0 / n);
+  for (long i = 0; i < n; i++) {
+    double angle = 2 * M_PI * i / n + 0.4;
+    z[i] = radius * (cos(angle) + sin(angle) * I);
+  }
+
+  for (int iteration = 0; iteration < POLY_MAX_ITERATIONS && found < n; iteration++) {
+    for (long i = 0; i < n; i++) {
+      if (converged[i]) continue;
+
+      double noise;
+      double complex correction = poly_newton_correction(a, n, z[i], &noise);
+      if (noise < least_noise[i]) {
+        least_noise[i] = noise;
+        best[i] = z[i];
+      }
+      double complex repulsion = 0;
+      for (long j = 0; j < n; j++) {
+        if (j != i) repulsion += 1 / (z[i] - z[j]);
+      }
+      double complex step = correction / (1 - correction * repulsion);
+      double size = cabs(step);
+      if (!isfinite(size)) continue;
+      z[i] -= step;
+
+      /* the step has stalled at the rounding error of z */
+      if (size <= DBL_EPSILON * cabs(z[i])) {
+        converged[i] = 1;
+        found++;
+      }
+    }
+  }
+
+  /* the roots of clusters wander in the rounding errors of p(z)
+     without stalling: at the cap they are accepted at the point
+     with the smallest p(z), if that is only noise */
+  for (long i = 0; i < n && found < n; i++) {
+    if (!converged[i] && least_noise[i] <= 1) {
+      z[i] = best[i];
+      converged[i] = 1;
+      found++;
+    }
+  }
+  free(least_noise);
+  free(best);
+  if (found < n) {
+    free(converged);
+    return 0;
+  }
+
+  /* from here on converged marks the roots already paired */
+  memset(converged, 0, n * sizeof(int));
+
+  /* roots that are real up to rounding errors become real */
+  for (long i = 0; i < n; i++) {
+    double noise;
+    if (cimag(z[i]) != 0 && fabs(cimag(z[i])) <= 1e-6 * cabs(z[i])) {
+      poly_newton_correction(a, n, creal(z[i]), &noise);
+      if (noise <= 1) z[i] = creal(z[i]);
+    }
+  }
+
+  /* pair every root above the real axis, the farthest from it first,
+     with the closest one below not paired yet, and make them exact
+     conjugates. The roots of a real polynomial left without a pair
+     are real ones moved off the axis by rounding errors */
+  qsort(z, n, sizeof(double complex), compare_imaginary_parts);
+  for (long i = 0; i < n && cimag(z[i]) > 0; i++) {
+    long closest = -1;
+    double distance = INFINITY;
+    for (long j = n - 1; j > i && cimag(z[j]) < 0; j--) {
+      if (!converged[j] && cabs(z[j] - conj(z[i])) < distance) {
+        closest = j;
+        distance = cabs(z[j] - conj(z[i]));
+      }
+    }
+    if (closest < 0) continue;
+    z[i] = (z[i] + conj(z[closest])) / 2;
+    z[closest] = conj(z[i]);
+    converged[i] = converged[closest] = 1;
+  }
+  for (long i = 0; i < n; i++) {
+    if (!converged[i]) z[i] = creal(z[i]);
+  }
+  free(converged);
+
+  qsort(z, degree, sizeof(double complex), compare_roots);
+  return 1;
+}
+
+/* Fit a polynomial of degree n to the m points (x[i], y[i]) taken
+   every stride values, in the least squares sense. Every point is
+   a row of the Vandermonde matrix, rotated into the triangular factor
+   r and the rotated right hand side c. Returns 0 if the points do not
+   determine the polynomial, otherwise the coefficients in a and the
+   sum of the squared residuals in rss */
+int poly_fit(const double *x, const double *y, long stride, long m, long n, double *a, double *rss) {
+  long columns = n + 1;
+  double *r = calloc(columns * columns, sizeof(double));
+  double *c = calloc(columns, sizeof(double));
+  double *row = malloc(columns * sizeof(double));
+  int ok = 0;
+
+  if (r == NULL || c == NULL || row == NULL) goto done;
+
+  *rss = 0;
+  for (long i = 0; i < m; i++) {
+    double xi = x[i * stride], rhs = y[i * stride];
+
+    row[n] = 1;
+    for (long j = n; j > 0; j--) row[j - 1] = row[j] * xi;
+
+    for (long j = 0; j < columns; j++) {
+      if (row[j] == 0) continue;
+      double *rj = &r[j * columns];
+      double h = hypot(rj[j], row[j]);
+      double cs = rj[j] / h, sn = row[j] / h;
+      for (long k = j; k < columns; k++) {
+        double t = rj[k];
+        rj[k] = cs * t + sn * row[k];
+        row[k] = cs * row[k] - sn * t;
+      }
+      double t = c[j];
+      c[j] = cs * t + sn * rhs;
+      rhs = cs * rhs - sn * t;
+    }
+    *rss += rhs * rhs;
+  }
+
+  double largest = 0;
+  for (long j = 0; j < columns; j++) largest = fmax(largest, fabs(r[j * columns + j]));
+  for (long j = 0; j < columns; j++) {
+    if (!(fabs(r[j * columns + j]) > columns * DBL_EPSILON * largest)) goto done;
+  }
+
+  for (long j = n; j >= 0; j--) {
+    double s = c[j];
+    for (long k = j + 1; k < columns; k++) s -= r[j * columns + k] * a[k];
+    a[j] = s / r[j * columns + j];
+  }
+  ok = 1;
+
+done:
+  free(r);
+  free(c);
+  free(row);
+  return ok;
+}
+
+/* Pop the degree of a polynomial from the x register, checking that
+   it is not below lowest and that the stack holds the coefficients
+   and extra values more. Returns -1 (logging why) on error */
+long pop_degree(char *name, long lowest, long extra) {
+  if (sp < 2) return -1;
+
+  double n = pop();
+  if (n != floor(n) || n < lowest || n + 1 + extra > sp) {
+    push(n);
+    sprintf(operation_log[n_operation_log], "%s: not a polynomial degree %lg", name, n);
+    n_operation_log ++;
+    return -1;
+  }
+  if (refuse_lazy(name, sp - (long)n - 1 - extra)) {
+    push(n);
+    return -1;
+  }
+  return (long)n;
+}
+
+/* Replace the x register (n), the y register and the n + 1
+   coefficients below with the polynomial at y. In dd mode the
+   evaluation is done in double-double */
+void poly_operation(void) {
+  long n = pop_degree("poly", 0, 1);
+  if (n < 0) return;
+
+  if (arithmetic_mode == 'd') {
+    dd x = pop_dd();
+    dd r = pick_dd(sp - n);
+    for (long k = 1; k <= n; k++) r = dd_add(dd_mul(r, x), pick_dd(sp - n + k));
+    sp -= n + 1;
+    push_dd(r);
+    sprintf(operation_log[n_operation_log], "poly of degree %ld at %lg = %lg", n, x.hi, r.hi);
+    n_operation_log ++;
+    return;
+  }
+
+  double x = pop();
+  double r = poly_evaluate(&stack[sp - n - 1], n, x);
+  sp -= n + 1;
+  push(r);
+  sprintf(operation_log[n_operation_log], "poly of degree %ld at %lg = %lg", n, x, r);
+  n_operation_log ++;
+}
+
+/* Replace the x register (n) and the n + 1 coefficients below with
+   nothing, and every other value of the stack with the polynomial
+   at that value */
+void polymap_operation(void) {
+  if (refuse_lazy("polymap", 0)) return;
+  long n = pop_degree("polymap", 0, 0);
+  if (n < 0) return;
+
+  sp -= n + 1;
+  poly_evaluate_many(&stack[sp], n, stack, sp);
+  memset(stack_lo, 0, sp * sizeof(double));
+
+  sprintf(operation_log[n_operation_log], "poly of degree %ld on %d values", n, sp);
+  n_operation_log ++;
+}
+
+/* Replace the x register (n) and the n + 1 coefficients below with
+   the n roots, pairs of real and imaginary parts sorted by real part */
+void polyroots_operation(void) {
+  long n = pop_degree("polyroots", 1, 0);
+  if (n < 0) return;
+
+  char *error = NULL;
+  double complex *z = NULL;
+
+  if (stack[sp - n - 1] == 0) error = "the highest coefficient is zero";
+  else if (!reserve_stack(n - 1)) error = "not enough room in the stack";
+  else if ((z = malloc(n * sizeof(double complex))) == NULL) error = "out of memory";
+  else if (!poly_roots(&stack[sp - n - 1], n, z)) error = "no convergence";
+
+  if (error) {
+    free(z);
+    push(n);
+    sprintf(operation_log[n_operation_log], "polyroots: %s", error);
+    n_operation_log ++;
+    return;
+  }
+
+  sp -= n + 1;
+  for (long i = 0; i < n; i++) {
+    stack[sp + 2 * i] = creal(z[i]);
+    stack[sp + 2 * i + 1] = cimag(z[i]);
+  }
+  memset(&stack_lo[sp], 0, 2 * n * sizeof(double));
+  sp += 2 * n;
+  free(z);
+
+  sprintf(operation_log[n_operation_log], "polyroots of degree %ld", n);
+  n_operation_log ++;
+}
+
+/* Replace the x register (n) and the rest of the stack, made of
+   pairs of x and y values, with the n + 1 coefficients of the
+   polynomial closest to the points in the least squares sense */
+void polyfit_operation(void) {
+  double rss;
+  if (refuse_lazy("polyfit", 0)) return;
+  long n = pop_degree("polyfit", 0, 0);
+  if (n < 0) return;
+
+  long m = sp / 2;
+  char *error = NULL;
+  double *a = NULL;
+
+  if (sp % 2 || m < n + 1) error = "need pairs of x and y values, one more than the degree";
+  else if ((a = malloc((n + 1) * sizeof(double))) == NULL) error = "out of memory";
+  else if (!poly_fit(stack, stack + 1, 2, m, n, a, &rss)) error = "the points do not determine the polynomial";
+
+  if (error) {
+    free(a);
+    push(n);
+    sprintf(operation_log[n_operation_log], "polyfit: %s", error);
+    n_operation_log ++;
+    return;
+  }
+
+  sp = 0;
+  for (long j = 0; j <= n; j++) push(a[j]);
+  free(a);
+
+  sprintf(operation_log[n_operation_log], "polyfit of degree %ld on %ld points, rms residual %lg", n, m, sqrt(rss / m));
+  n_operation_log ++;
+}
@@ -0,0 +1,259 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/* dc2.c -- Dave's (RPN) Calculator
+ *
+ * A simple RPN calculator for terminal
+ * made with love in Italy.
+ *
+ * Copyright 2025 Davide Mastromatteo
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation version 2 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+/* ----------------
+   RANDOM NUMBERS
+   ---------------- */
+
+/* Random numbers come from xoshiro256++ (Blackman and Vigna).
+   Every generator is a small value type: a copy advanced with
+   random_jump() gives a stream that does not overlap the original for
+   2^128 draws, which is how independent streams are made. Bulk fills
+   run RANDOM_LANES such streams side by side, laid out so that the
+   compiler can keep them in vector registers */
+
+#define RANDOM_LANES 4
+
+#define ZIGGURAT_NORMAL_LAYERS 128
+#define ZIGGURAT_NORMAL_R 3.442619855899
+#define ZIGGURAT_NORMAL_V 9.91256303526217e-3
+
+#define ZIGGURAT_EXP_LAYERS 256
+#define ZIGGURAT_EXP_R 7.69711747013104972
+#define ZIGGURAT_EXP_V 3.949659822581572e-3
+
+typedef struct {
+  uint64_t s[4];
+} random_state;
+
+typedef struct {
+  uint64_t s[4][RANDOM_LANES];
+} random_lanes;
+
+random_state random_generator;
+random_lanes random_bulk_generator;
+
+/* Ziggurat tables: layer edges x and the ratios x[i+1] / x[i] */
+double ziggurat_normal_x[ZIGGURAT_NORMAL_LAYERS + 1];
+double ziggurat_normal_r[ZIGGURAT_NORMAL_LAYERS];
+double ziggurat_exp_x[ZIGGURAT_EXP_LAYERS + 1];
+double ziggurat_exp_r[ZIGGURAT_EXP_LAYERS];
+
+uint64_t rotl(uint64_t x, int k) {
+  return (x << k) | (x >> (64 - k));
+}
+
+/* Get the next 64 random bits of a generator */
+uint64_t random_next(random_state *g) {
+  uint64_t *s = g->s;
+  uint64_t result = rotl(s[0] + s[3], 23) + s[0];
+  uint64_t t = s[1] << 17;
+
+  s[2] ^= s[0];
+  s[3] ^= s[1];
+  s[1] ^= s[2];
+  s[0] ^= s[3];
+  s[2] ^= t;
+  s[3] = rotl(s[3], 45);
+
+  return result;
+}
+
+/* Advance a generator by 2^128 draws */
+void random_jump(random_state *g) {
+  static const uint64_t jump[] = { 0x180ec6d33cfd0abaULL, 0xd5a61266f0c9392cULL,
+                                   0xa9582618e03fc9aaULL, 0x39abdc4529b1661cULL };
+  uint64_t s[4] = { 0, 0, 0, 0 };
+
+  for (int i = 0; i < 4; i++) {
+    for (int b = 0; b < 64; b++) {
+      if (jump[i] & ((uint64_t)1 << b)) {
+        for (int k = 0; k < 4; k++) s[k] ^= g->s[k];
+      }
+      random_next(g);
+    }
+  }
+
+  memcpy(g->s, s, sizeof(s));
+}
+
+/* Turn 64 random bits into a double in [0, 1) */
+double random_bits_to_double(uint64_t bits) {
+  return (double)(bits >> 11) * 0x1.0p-53;
+}
+
+double random_uniform(random_state *g) {
+  return random_bits_to_double(random_next(g));
+}
+
+/* Compute the high 64 bits of a 64x64 bits product,
+   the low ones are stored in lo */
+uint64_t multiply_high(uint64_t a, uint64_t b, uint64_t *lo) {
+  uint64_t a_lo = a & 0xffffffff, a_hi = a >> 32;
+  uint64_t b_lo = b & 0xffffffff, b_hi = b >> 32;
+  uint64_t p0 = a_lo * b_lo, p1 = a_lo * b_hi, p2 = a_hi * b_lo, p3 = a_hi * b_hi;
+  uint64_t middle = (p0 >> 32) + (p1 & 0xffffffff) + (p2 & 0xffffffff);
+
+  *lo = (middle << 32) | (p0 & 0xffffffff);
+  return p3 + (p1 >> 32) + (p2 >> 32) + (middle >> 32);
+}
+
+/* Get an unbiased random integer in [0, range) with Lemire's
+   multiply-and-shift method, which needs a division only when
+   the candidate falls in the small biased zone */
+uint64_t random_bounded(random_state *g, uint64_t range) {
+  uint64_t lo;
+  uint64_t hi = multiply_high(random_next(g), range, &lo);
+
+  if (lo < range) {
+    uint64_t threshold = (0 - range) % range;
+    while (lo < threshold) hi = multiply_high(random_next(g), range, &lo);
+  }
+
+  return hi;
+}
+
+/* Draw from the tail of the normal distribution beyond r */
+double random_normal_tail(random_state *g, double r, int negative) {
+  double x, y;
+  do {
+    x = log(random_uniform(g)) / r;
+    y = log(random_uniform(g));
+  } while (-2 * y < x * x);
+  return negative ? x - r : r - x;
+}
+
+/* Draw a standard normal number with the ziggurat method
+   (Marsaglia and Tsang, in Doornik's formulation) */
+double random_normal(random_state *g) {
+  for (;;) {
+    uint64_t bits = random_next(g);
+    double u = 2 * random_bits_to_double(bits) - 1;
+    int i = bits & (ZIGGURAT_NORMAL_LAYERS - 1);
+
+    if (fabs(u) < ziggurat_normal_r[i]) return u * ziggurat_normal_x[i];
+    if (i == 0) return random_normal_tail(g, ZIGGURAT_NORMAL_R, u < 0);
+
+    double x = u * ziggurat_normal_x[i];
+    double f0 = exp(-0.5 * (ziggurat_normal_x[i] * ziggurat_normal_x[i] - x * x));
+    double f1 = exp(-0.5 * (ziggurat_normal_x[i + 1] * ziggurat_normal_x[i + 1] - x * x));
+    if (f1 + random_uniform(g) * (f0 - f1) < 1.0) return x;
+  }
+}
+
+/* Draw an exponential number of rate 1 with the ziggurat method */
+double random_exponential(random_state *g) {
+  for (;;) {
+    uint64_t bits = random_next(g);
+    double u = random_bits_to_double(bits);
+    int i = bits & (ZIGGURAT_EXP_LAYERS - 1);
+
+    if (u < ziggurat_exp_r[i]) return u * ziggurat_exp_x[i];
+    if (i == 0) return ZIGGURAT_EXP_R - log(1 - random_uniform(g));
+
+    double x = u * ziggurat_exp_x[i];
+    double f0 = exp(x - ziggurat_exp_x[i]);
+    double f1 = exp(x - ziggurat_exp_x[i + 1]);
+    if (f1 + random_uniform(g) * (f0 - f1) < 1.0) return x;
+  }
+}
+
+/* Build the ziggurat tables */
+void ziggurat_setup(void) {
+  double f = exp(-0.5 * ZIGGURAT_NORMAL_R * ZIGGURAT_NORMAL_R);
+  ziggurat_normal_x[0] = ZIGGURAT_NORMAL_V / f;
+  ziggurat_normal_x[1] = ZIGGURAT_NORMAL_R;
+  ziggurat_normal_x[ZIGGURAT_NORMAL_LAYERS] = 0;
+  for (int i = 2; i < ZIGGURAT_NORMAL_LAYERS; i++) {
+    ziggurat_normal_x[i] = sqrt(-2 * log(ZIGGURAT_NORMAL_V / ziggurat_normal_x[i - 1] + f));
+    f = exp(-0.5 * ziggurat_normal_x[i] * ziggurat_normal_x[i]);
+  }
+  for (int i = 0; i < ZIGGURAT_NORMAL_LAYERS; i++) {
+    ziggurat_normal_r[i] = ziggurat_normal_x[i + 1] / ziggurat_normal_x[i];
+  }
+
+  f = exp(-ZIGGURAT_EXP_R);
+  ziggurat_exp_x[0] = ZIGGURAT_EXP_V / f;
+  ziggurat_exp_x[1] = ZIGGURAT_EXP_R;
+  ziggurat_exp_x[ZIGGURAT_EXP_LAYERS] = 0;
+  for (int i = 2; i < ZIGGURAT_EXP_LAYERS; i++) {
+    ziggurat_exp_x[i] = -log(ZIGGURAT_EXP_V / ziggurat_exp_x[i - 1] + f);
+    f = exp(-ziggurat_exp_x[i]);
+  }
+  for (int i = 0; i < ZIGGURAT_EXP_LAYERS; i++) {
+    ziggurat_exp_r[i] = ziggurat_exp_x[i + 1] / ziggurat_exp_x[i];
+  }
+}
+
+/* Seed the generators expanding the seed with splitmix64 */
+void random_seed(uint64_t seed) {
+  for (int k = 0; k < 4; k++) {
+    uint64_t z = (seed += 0x9e3779b97f4a7c15ULL);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    random_generator.s[k] = z ^ (z >> 31);
+  }
+
+  /* the bulk lanes follow the main stream, one jump apart */
+  random_state lane = random_generator;
+  for (int i = 0; i < RANDOM_LANES; i++) {
+    random_jump(&lane);
+    for (int k = 0; k < 4; k++) random_bulk_generator.s[k][i] = lane.s[k];
+  }
+
+  ziggurat_setup();
+}
+
+/* Fill an array with uniform numbers in [0, 1), drawing from all
+   the lanes at every step so that the loop can be vectorised.
+   The values are built from 52 random bits placed in the mantissa
+   of a number in [1, 2), as vector units lack a 64 bits integer to
+   double conversion */
+void random_fill_uniform(random_lanes *g, double *out, long n) {
+  uint64_t s[4][RANDOM_LANES];
+  long i = 0;
+
+  /* a local copy of the state cannot alias the output */
+  memcpy(s, g->s, sizeof(s));
+
+  for (; i + RANDOM_LANES <= n; i += RANDOM_LANES) {
+    for (int l = 0; l < RANDOM_LANES; l++) {
+      uint64_t sum = s[0][l] + s[3][l];
+      uint64_t result = ((sum << 23) | (sum >> 41)) + s[0][l];
+      uint64_t t = s[1][l] << 17;
+      s[2][l] ^= s[0][l];
+      s[3][l] ^= s[1][l];
+      s[1][l] ^= s[2][l];
+      s[0][l] ^= s[3][l];
+      s[2][l] ^= t;
+      s[3][l] = (s[3][l] << 45) | (s[3][l] >> 19);
+      out[i + l] = bits_to_double((result >> 12) | 0x3ff0000000000000ULL) - 1.0;
+    }
+  }
+
+  /* the last few values come from the first lane */
+  random_state lane = { { s[0][0], s[1][0], s[2][0], s[3][0] } };
+  for (; i < n; i++) out[i] = random_uniform(&lane);
+  for (int k = 0; k < 4; k++) s[k][0] = lane.s[k];
+
+  memcpy(g->s, s, sizeof(s));
+}
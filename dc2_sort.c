@@ -0,0 +1,331 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/* dc2.c -- Dave's (RPN) Calculator
+ *
+ * A simple RPN calculator for terminal
+ * made with love in Italy.
+ *
+ * Copyright 2025 Davide Mastromatteo
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation version 2 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+/* ---------------------------------
+   SORTING, SELECTION AND SCANS
+   --------------------------------- */
+
+/* These commands work on the whole stack at once, in double precision.
+   Doubles are sorted and selected through integer keys with the same
+   order: flipping the sign bit of the positive numbers and all the bits
+   of the negative ones gives keys that compare like the numbers, with
+   -0 before 0 and the NaNs at the ends. So a LSD radix sort can be
+   used, and the selection needs no special case for NaN */
+
+#define RADIX_BITS 11
+#define RADIX_SIZE (1 << RADIX_BITS)
+#define RADIX_PASSES 6
+#define INSERTION_SORT_MAX 32
+
+/* Scans split the stack in this many chunks that are scanned at the
+   same time, so that the additions do not wait for each other */
+#define SCAN_LANES 4
+#define SCAN_MIN_LENGTH 64
+
+uint64_t sort_key(double x) {
+  uint64_t bits = double_to_bits(x);
+  uint64_t mask = (uint64_t)((int64_t)bits >> 63) | 0x8000000000000000ULL;
+  return bits ^ mask;
+}
+
+double sort_key_to_double(uint64_t key) {
+  uint64_t mask = (uint64_t)((int64_t)~key >> 63) | 0x8000000000000000ULL;
+  return bits_to_double(key ^ mask);
+}
+
+void insertion_sort_keys(uint64_t *keys, long n) {
+  for (long i = 1; i < n; i++) {
+    uint64_t k = keys[i];
+    long j = i;
+    for (; j > 0 && keys[j - 1] > k; j--) keys[j] = keys[j - 1];
+    keys[j] = k;
+  }
+}
+
+/* Sort the keys in ascending order with a LSD radix sort.
+   All the histograms are counted in a single pass over the keys,
+   and the passes where all the keys share the digit are skipped.
+   buffer must have room for n keys */
+void radix_sort_keys(uint64_t *keys, uint64_t *buffer, long n) {
+  static long count[RADIX_PASSES][RADIX_SIZE];
+  uint64_t *from = keys, *to = buffer;
+
+  if (n <= INSERTION_SORT_MAX) {
+    insertion_sort_keys(keys, n);
+    return;
+  }
+
+  memset(count, 0, sizeof(count));
+  for (long i = 0; i < n; i++) {
+    for (int p = 0; p < RADIX_PASSES; p++) {
+      count[p][(keys[i] >> (p * RADIX_BITS)) & (RADIX_SIZE - 1)]++;
+    }
+  }
+
+  for (int p = 0; p < RADIX_PASSES; p++) {
+    int shift = p * RADIX_BITS;
+    if (count[p][(keys[0] >> shift) & (RADIX_SIZE - 1)] == n) continue;
+
+    long offset = 0;
+    for (int d = 0; d < RADIX_SIZE; d++) {
+      long c = count[p][d];
+      count[p][d] = offset;
+      offset += c;
+    }
+    for (long i = 0; i < n; i++) {
+      uint64_t k = from[i];
+      to[count[p][(k >> shift) & (RADIX_SIZE - 1)]++] = k;
+    }
+
+    uint64_t *t = from;
+    from = to;
+    to = t;
+  }
+
+  if (from != keys) memcpy(keys, from, n * sizeof(uint64_t));
+}
+
+/* Find the i-th smallest key with introselect: quickselect with a
+   median of three pivot, falling back to sorting the remaining range
+   when the partitions do not shrink fast enough. On return the keys
+   before i are not greater and the ones after i are not smaller */
+uint64_t select_key(uint64_t *keys, uint64_t *buffer, long n, long i) {
+  long lo = 0, hi = n - 1;
+  int depth = 0;
+
+  for (long m = n; m > 1; m >>= 1) depth += 2;
+
+  while (hi - lo > INSERTION_SORT_MAX) {
+    if (depth-- == 0) {
+      radix_sort_keys(keys + lo, buffer, hi - lo + 1);
+      return keys[i];
+    }
+
+    /* order keys[lo], keys[mid], keys[hi] and move the median to lo */
+    long mid = lo + (hi - lo) / 2;
+    uint64_t t;
+    if (keys[mid] < keys[lo]) { t = keys[mid]; keys[mid] = keys[lo]; keys[lo] = t; }
+    if (keys[hi] < keys[mid]) { t = keys[hi]; keys[hi] = keys[mid]; keys[mid] = t; }
+    if (keys[mid] < keys[lo]) { t = keys[mid]; keys[mid] = keys[lo]; keys[lo] = t; }
+    t = keys[mid]; keys[mid] = keys[lo]; keys[lo] = t;
+
+    /* Hoare partition: keys[lo..b] <= pivot <= keys[b+1..hi] */
+    uint64_t pivot = keys[lo];
+    long a = lo - 1, b = hi + 1;
+    for (;;) {
+      do a++; while (keys[a] < pivot);
+      do b--; while (keys[b] > pivot);
+      if (a >= b) break;
+      t = keys[a]; keys[a] = keys[b]; keys[b] = t;
+    }
+
+    if (i <= b) hi = b;
+    else lo = b + 1;
+  }
+
+  insertion_sort_keys(keys + lo, hi - lo + 1);
+  return keys[i];
+}
+
+/* Copy the values of the stack into keys, returning the number of
+   values or 0 if the memory for the keys and the buffer is missing */
+long stack_to_keys(uint64_t **keys, uint64_t **buffer) {
+  *keys = malloc(sp * sizeof(uint64_t));
+  *buffer = malloc(sp * sizeof(uint64_t));
+  if (*keys == NULL || *buffer == NULL) {
+    free(*keys);
+    free(*buffer);
+    printf("Out Of Memory\n");
+    return 0;
+  }
+  for (long i = 0; i < sp; i++) (*keys)[i] = sort_key(stack[i]);
+  return sp;
+}
+
+/* Sort the stack: ascending puts the largest value in the x register */
+void sort_stack(int descending) {
+  uint64_t *keys, *buffer;
+  long n;
+
+  if (sp < 2 || refuse_lazy(descending ? "rsort" : "sort", 0)) return;
+  if (!(n = stack_to_keys(&keys, &buffer))) return;
+
+  radix_sort_keys(keys, buffer, n);
+  for (long i = 0; i < n; i++) {
+    stack[descending ? n - 1 - i : i] = sort_key_to_double(keys[i]);
+  }
+  memset(stack_lo, 0, n * sizeof(double));
+
+  free(keys);
+  free(buffer);
+}
+
+void sort_operation(void) {
+  sort_stack(0);
+}
+
+void rsort_operation(void) {
+  sort_stack(1);
+}
+
+/* Replace the stack with the value at position h of the sorted
+   stack (0 = smallest), interpolating linearly between the two
+   closest values when h is not an integer */
+void replace_stack_with_order_statistic(double h, char *name) {
+  uint64_t *keys, *buffer;
+  long n;
+
+  if (sp < 1) return;
+  if (!(n = stack_to_keys(&keys, &buffer))) return;
+
+  long j = (long)floor(h);
+  double result = sort_key_to_double(select_key(keys, buffer, n, j));
+
+  if (h > j && j + 1 < n) {
+    /* after the selection the next value is the smallest above j */
+    uint64_t next = keys[j + 1];
+    for (long i = j + 2; i < n; i++) if (keys[i] < next) next = keys[i];
+    result += (h - j) * (sort_key_to_double(next) - result);
+  }
+
+  free(keys);
+  free(buffer);
+
+  sprintf(operation_log[n_operation_log], "%s of %ld values = %lg", name, n, result);
+  n_operation_log ++;
+
+  sp = 0;
+  push(result);
+}
+
+/* Replace the stack with its median */
+void median_operation(void) {
+  if (refuse_lazy("median", 0)) return;
+  replace_stack_with_order_statistic((sp - 1) / 2.0, "median");
+}
+
+/* Replace the stack with its x-th smallest value (1 = minimum) */
+void nth_operation(void) {
+  if (sp < 2 || refuse_lazy("nth", 0)) return;
+
+  double k = pop();
+  if (k != floor(k) || k < 1 || k > sp) {
+    push(k);
+    sprintf(operation_log[n_operation_log], "nth: %lg is not between 1 and %d", k, sp);
+    n_operation_log ++;
+    return;
+  }
+  replace_stack_with_order_statistic(k - 1, "nth");
+}
+
+/* Replace the stack with its x-th percentile, interpolating
+   between the closest ranks */
+void percentile_operation(void) {
+  if (sp < 2 || refuse_lazy("percentile", 0)) return;
+
+  double p = pop();
+  if (!(p >= 0 && p <= 100)) {
+    push(p);
+    sprintf(operation_log[n_operation_log], "percentile: %lg is not between 0 and 100", p);
+    n_operation_log ++;
+    return;
+  }
+  replace_stack_with_order_statistic((sp - 1) * p / 100, "percentile");
+}
+
+/* Remove the repeated adjacent values, as uniq(1) does.
+   Use it after sort to keep the distinct values only */
+void uniq_operation(void) {
+  if (sp < 2 || refuse_lazy("uniq", 0)) return;
+
+  int n = 1;
+  for (int i = 1; i < sp; i++) {
+    if (double_to_bits(stack[i]) != double_to_bits(stack[n - 1])) {
+      stack[n] = stack[i];
+      stack_lo[n] = stack_lo[i];
+      n++;
+    }
+  }
+
+  sprintf(operation_log[n_operation_log], "uniq removed %d values", sp - n);
+  n_operation_log ++;
+  sp = n;
+}
+
+/* Replace every value with the sum of the values from the bottom of
+   the stack up to it. Long arrays are cut in SCAN_LANES chunks scanned
+   side by side, then the totals of the previous chunks are added */
+void prefix_sum(double *v, long n) {
+  double total[SCAN_LANES] = { 0 };
+  long chunk = (n >= SCAN_MIN_LENGTH) ? n / SCAN_LANES : 0;
+
+  for (long i = 0; i < chunk; i++) {
+    for (int l = 0; l < SCAN_LANES; l++) {
+      total[l] += v[l * chunk + i];
+      v[l * chunk + i] = total[l];
+    }
+  }
+
+  double offset = 0;
+  for (int l = 1; l < SCAN_LANES && chunk > 0; l++) {
+    offset += total[l - 1];
+    double *c = v + l * chunk;
+    for (long i = 0; i < chunk; i++) c[i] += offset;
+  }
+
+  for (long i = SCAN_LANES * chunk; i < n; i++) v[i] += (i > 0) ? v[i - 1] : 0;
+}
+
+/* Replace every value with the product of the values from the bottom
+   of the stack up to it, scanning in chunks like prefix_sum() */
+void prefix_product(double *v, long n) {
+  double total[SCAN_LANES];
+  long chunk = (n >= SCAN_MIN_LENGTH) ? n / SCAN_LANES : 0;
+
+  for (long i = 0; i < chunk; i++) {
+    for (int l = 0; l < SCAN_LANES; l++) {
+      total[l] = (i > 0) ? total[l] * v[l * chunk + i] : v[l * chunk + i];
+      v[l * chunk + i] = total[l];
+    }
+  }
+
+  double offset = 1;
+  for (int l = 1; l < SCAN_LANES && chunk > 0; l++) {
+    offset *= total[l - 1];
+    double *c = v + l * chunk;
+    for (long i = 0; i < chunk; i++) c[i] *= offset;
+  }
+
+  for (long i = SCAN_LANES * chunk; i < n; i++) v[i] *= (i > 0) ? v[i - 1] : 1;
+}
+
+void cumsum_operation(void) {
+  if (refuse_lazy("cumsum", 0)) return;
+  prefix_sum(stack, sp);
+  memset(stack_lo, 0, sp * sizeof(double));
+}
+
+void cumprod_operation(void) {
+  if (refuse_lazy("cumprod", 0)) return;
+  prefix_product(stack, sp);
+  memset(stack_lo, 0, sp * sizeof(double));
+}
@@ -32,6 +32,15 @@ double pick(int sp) {
   return stack[sp - 1];  
 }
 
+/* Pick a double-double value from the stack without popping it */
+dd pick_dd(int sp) {
+  if (sp == 0) {
+    return dd_from_double(0);
+  }
+  dd result = { stack[sp - 1], stack_lo[sp - 1] };
+  return result;
+}
+
 /* Pop a value from the stack returning it to the caller */
 double pop(void) {
   if (sp == 0) {
@@ -44,19 +53,66 @@ double pop(void) {
   return result;
 }
 
+/* Pop a double-double value from the stack returning it to the caller */
+dd pop_dd(void) {
+  if (sp == 0) {
+    printf("No value left in the stack\n");
+    return dd_from_double(0);
+  }
+
+  dd result = pick_dd(sp);
+  sp--;
+  return result;
+}
+
 /* Drop a value from the stack */
 void drop(void) {
   pop();
 }
 
+/* Make room for n more values, growing the stack geometrically.
+   Returns 0 if the stack cannot grow */
+int reserve_stack(long n) {
+  long needed = sp + n;
+  if (needed <= stack_capacity) return 1;
+  if (needed > STACK_MAX_LENGTH) return 0;
+
+  long capacity = stack_capacity * 2;
+  if (capacity < needed) capacity = needed;
+  if (capacity > STACK_MAX_LENGTH) capacity = STACK_MAX_LENGTH;
+
+  double *grown = realloc(stack, capacity * sizeof(double));
+  if (grown == NULL) return 0;
+  stack = grown;
+  grown = realloc(stack_lo, capacity * sizeof(double));
+  if (grown == NULL) return 0;
+  stack_lo = grown;
+
+  stack_capacity = capacity;
+  return 1;
+}
+
 /* Push a value to the stack */
 void push(double val) {
-    if (sp >= STACK_LENGTH) {
+    if (!reserve_stack(1)) {
       printf("Out Of Memory, prevented a stack overflow\n");
       return;
     }
 
     stack[sp] = val;
+    stack_lo[sp] = 0;
+    sp++;
+}
+
+/* Push a double-double value to the stack */
+void push_dd(dd val) {
+    if (!reserve_stack(1)) {
+      printf("Out Of Memory, prevented a stack overflow\n");
+      return;
+    }
+
+    stack[sp] = val.hi;
+    stack_lo[sp] = val.lo;
     sp++;
 }
 
@@ -69,10 +125,10 @@ void clear(void) {
 /* Swap the x and y register */
 void swap(void) {
   if (sp<2) return;
-  double x = pop();
-  double y = pop();
-  push(x);
-  push(y);
+  dd x = pop_dd();
+  dd y = pop_dd();
+  push_dd(x);
+  push_dd(y);
 }
 
 /* roll the entire stack to the left: the third item become the second, 
@@ -80,10 +136,14 @@ void swap(void) {
    become the last */
 void lroll(void) {
   if (sp == 0) return;
-  double first_value = pick(1); 
+  dd first_value = pick_dd(1); 
 
-  for (int i=0; i<((sp) - 1); i++) stack[i] = stack[i+1];
-  stack[sp - 1] = first_value;
+  for (int i=0; i<((sp) - 1); i++) {
+    stack[i] = stack[i+1];
+    stack_lo[i] = stack_lo[i+1];
+  }
+  stack[sp - 1] = first_value.hi;
+  stack_lo[sp - 1] = first_value.lo;
 }
 
 /* roll the entire stack to the right: the first item become the second, 
@@ -91,8 +151,12 @@ void lroll(void) {
    become the first */
 void rroll(void) {
   if (sp == 0) return;
-  double last_value = pick(sp);
+  dd last_value = pick_dd(sp);
 
-  for (int i=(sp - 1); i>0; i--) stack[i] = stack[i-1];
-  stack[0] = last_value;
+  for (int i=(sp - 1); i>0; i--) {
+    stack[i] = stack[i-1];
+    stack_lo[i] = stack_lo[i-1];
+  }
+  stack[0] = last_value.hi;
+  stack_lo[0] = last_value.lo;
 }
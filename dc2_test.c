@@ -0,0 +1,945 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/* dc2.c -- Dave's (RPN) Calculator
+ *
+ * A simple RPN calculator for terminal
+ * made with love in Italy.
+ *
+ * Copyright 2025 Davide Mastromatteo
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation version 2 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+/* ------------
+   TESTS
+   ------------ */
+
+/* Checks of the numerical functions, run by "make check". The whole
+   calculator is included, its main renamed, so that every function
+   can be called directly */
+
+#define main dc2_main
+#include "dc2.c"
+#undef main
+
+int failures = 0;
+
+void check(int condition, char *name) {
+  if (!condition) {
+    printf("FAIL %s\n", name);
+    failures++;
+  }
+}
+
+/* Start from an empty stack and history */
+void reset(void) {
+  sp = 0;
+  n_operation_log = 0;
+}
+
+int last_log_contains(char *text) {
+  return n_operation_log > 0 && strstr(operation_log[n_operation_log - 1], text) != NULL;
+}
+
+/* Every root that is not real has its conjugate among the roots */
+int conjugate_pairs(double complex *z, long n) {
+  for (long i = 0; i < n; i++) {
+    int found = cimag(z[i]) == 0;
+    for (long j = 0; j < n && !found; j++) found = z[j] == conj(z[i]);
+    if (!found) return 0;
+  }
+  return 1;
+}
+
+/* Wilkinson's polynomial (x - 1)(x - 2)...(x - 20), its coefficients
+   rounded to doubles: the roots are real and very ill-conditioned */
+void test_wilkinson_roots(void) {
+  double a[21] = {
+    1.0, -210.0, 20615.0, -1256850.0, 53327946.0, -1672280820.0,
+    40171771630.0, -756111184500.0, 11310276995381.0, -135585182899530.0,
+    1307535010540395.0, -1.014229986551145e+16, 6.30308120992949e+16,
+    -3.1133364316139066e+17, 1.2066478037803732e+18, -3.599979517947607e+18,
+    8.037811822645051e+18, -1.2870931245150988e+19, 1.3803759753640704e+19,
+    -8.7529480367616e+18, 2.43290200817664e+18
+  };
+  double complex z[20];
+  int close = 1;
+
+  check(poly_roots(a, 20, z), "wilkinson roots converge");
+  for (int i = 0; i < 20; i++) {
+    close &= cimag(z[i]) == 0 && fabs(creal(z[i]) - (i + 1)) <= 1e-3 * (i + 1);
+  }
+  check(close, "wilkinson roots are real and close to 1 ... 20");
+}
+
+/* (x - 1)^5 (x + 2)^3: clusters of multiple roots */
+void test_clustered_roots(void) {
+  double a[9] = { 1 }, roots[8] = { 1, 1, 1, 1, 1, -2, -2, -2 };
+  double complex z[8];
+  int near_one = 0, near_minus_two = 0;
+
+  for (int i = 0; i < 8; i++) {
+    for (int k = i + 1; k > 0; k--) a[k] -= roots[i] * a[k - 1];
+  }
+
+  check(poly_roots(a, 8, z), "clustered roots converge");
+  for (int i = 0; i < 8; i++) {
+    near_one += cabs(z[i] - 1) < 1e-2;
+    near_minus_two += cabs(z[i] + 2) < 1e-4;
+  }
+  check(near_one == 5 && near_minus_two == 3, "clustered roots are close to 1 and -2");
+  check(conjugate_pairs(z, 8), "clustered roots come in conjugate pairs");
+}
+
+/* Random polynomials: every root is a root of a polynomial close to
+   the given one, and the complex ones come in pairs */
+void test_random_roots(void) {
+  double a[101];
+  double complex z[100];
+  double worst = 0;
+
+  random_seed(1);
+  for (int i = 0; i <= 100; i++) a[i] = random_uniform(&random_generator) - 0.5;
+
+  check(poly_roots(a, 100, z), "random roots converge");
+  for (int i = 0; i < 100; i++) {
+    double complex p = a[0];
+    double bound = fabs(a[0]);
+    for (int k = 1; k <= 100; k++) {
+      p = p * z[i] + a[k];
+      bound = bound * cabs(z[i]) + fabs(a[k]);
+    }
+    worst = fmax(worst, cabs(p) / bound);
+  }
+  check(worst < 1e-13, "random roots have small backward errors");
+  check(conjugate_pairs(z, 100), "random roots come in conjugate pairs");
+}
+
+/* The double-double operations near the ends of the range of double:
+   no worse than double there */
+void test_dd_limits(void) {
+  char buffer[64];
+  dd big = dd_from_string("1e301");
+
+  check(dd_mul(big, dd_from_double(2)).hi == 2e301, "dd 1e301 * 2");
+  check(dd_div(dd_from_double(5), big).hi == 5e-301, "dd 5 / 1e301");
+  check(dd_mul(dd_from_string("1e300"), dd_from_string("1e300")).hi == INFINITY, "dd 1e300 * 1e300");
+  check(dd_div(dd_from_double(1), dd_from_double(0)).hi == INFINITY, "dd 1 / 0");
+  check(dd_power(dd_from_double(0.5), dd_from_double(0)).hi == 0, "dd 0 ^ 0.5");
+  check(dd_power(dd_from_double(-1), dd_from_double(0)).hi == INFINITY, "dd 0 ^ -1");
+  check(dd_from_string("1e-320").hi == 1e-320, "dd 1e-320");
+  check(dd_from_string("1e400").hi == INFINITY, "dd 1e400");
+  check(dd_log(dd_from_double(INFINITY)).hi == INFINITY, "dd log inf");
+  check(fabs(dd_log(dd_from_double(1e-320)).hi - log(1e-320)) < 1e-13, "dd log 1e-320");
+  check(dd_sqrt(dd_from_double(0x1p-1070)).hi == 0x1p-535, "dd sqrt 2^-1070");
+
+  dd_to_string(buffer, dd_power(dd_from_double(1000), dd_from_double(2)), 31);
+  check(strcmp(buffer, "1.07150860718626732094842504906e+301") == 0, "dd 2 ^ 1000 digits");
+  /* exponents past 300 are reached in steps of 10^300 */
+  dd_to_string(buffer, dd_from_string("1234567890123456789012345678901e-320"), 31);
+  check(strcmp(buffer, "1.234567890123456789012345678901e-290") == 0, "dd 31 digits e-320");
+  dd_to_string(buffer, dd_from_string("0.000000000001234567890123456789012345678901e310"), 31);
+  check(strcmp(buffer, "1.234567890123456789012345678901e+298") == 0, "dd 31 digits e310");
+  dd_to_string(buffer, dd_from_double(1e305), 5);
+  check(strcmp(buffer, "1e+305") == 0, "dd 1e305 digits");
+  dd_to_string(buffer, dd_from_double(0x1p-1074), 5);
+  check(strcmp(buffer, "4.9407e-324") == 0, "dd 2^-1074 digits");
+  dd_to_string(buffer, dd_exp(dd_from_double(709.7)), 5);
+  check(strcmp(buffer, "1.655e+308") == 0, "dd exp 709.7 digits");
+}
+
+/* digamma and trigamma at 1 and 1/2, where they are known in closed
+   form: -γ, π²/6, -γ - 2 log 2 and π²/2 */
+void test_polygamma(void) {
+  const double euler_gamma = 0.57721566490153286;
+
+  check(fabs(digamma(1) + euler_gamma) < 1e-15, "digamma(1)");
+  check(fabs(trigamma(1) - M_PI * M_PI / 6) < 2e-15, "trigamma(1)");
+  check(fabs(digamma(0.5) + euler_gamma + 2 * M_LN2) < 2e-15, "digamma(0.5)");
+  check(fabs(trigamma(0.5) - M_PI * M_PI / 2) < 5e-15, "trigamma(0.5)");
+}
+
+/* Sequences keep the modes in force when their operations were
+   applied, and give the values computed one at a time */
+void test_lazy_sequences(void) {
+  long double sum = 0;
+  int same = 1;
+
+  /* deg 1 90 range sin rad sumx */
+  reset();
+  set_mode('d');
+  push(1);
+  push(90);
+  range_operation();
+  compute_lazy_operation("sin");
+  set_mode('r');
+  sumx_operation();
+  for (int i = 1; i <= 90; i++) sum += sin_degrees(i);
+  check(sp == 1 && fabs(pick(1) - (double)sum) < 1e-13, "sequence keeps the angle mode");
+
+  /* the functions of fast precision (which differ from libm in the
+     last bit for some of these values) and the float factorial of
+     exact mode, whatever the modes when the values are read */
+  reset();
+  set_precision('f');
+  set_arithmetic_mode('x');
+  push(0);
+  push(1000);
+  range_operation();
+  compute_lazy_operation("sin");
+  compute_lazy_operation("!");
+  set_precision('a');
+  set_arithmetic_mode('f');
+  eval_operation();
+  for (int i = 0; i <= 1000; i++) same &= stack[i] == factorial(fast_sin(i));
+  check(sp == 1001 && same, "sequence keeps the precision and exact mode");
+
+  reset();
+  set_mode('d');
+  set_precision('f');
+  push(0);
+  push(1000);
+  range_operation();
+  compute_lazy_operation("cos");
+  set_mode('r');
+  set_precision('a');
+  eval_operation();
+  same = 1;
+  for (int i = 0; i <= 1000; i++) same &= stack[i] == fast_cos_degrees(i);
+  check(sp == 1001 && same, "sequence keeps the precision in degrees");
+
+  /* 2 / (3 sqrt(x)) for x in 1 ... 10000, by sumx, meanx and eval */
+  for (int reduction = 0; reduction < 3; reduction++) {
+    reset();
+    push(2);
+    push(1);
+    push(10000);
+    range_operation();
+    compute_lazy_operation("sqrt");
+    push(3);
+    compute_lazy_operation("*");
+    compute_lazy_operation("/");
+    if (reduction == 0) sumx_operation();
+    if (reduction == 1) meanx_operation();
+    if (reduction == 2) eval_operation();
+
+    sum = 0;
+    same = 1;
+    for (int i = 1; i <= 10000; i++) {
+      double v = 2 / (sqrt(i) * 3);
+      sum += v;
+      if (reduction == 2) same &= stack[i - 1] == v;
+    }
+    if (reduction == 0) check(sp == 1 && fabs(pick(1) / (double)sum - 1) < 1e-15, "sumx of a sequence");
+    if (reduction == 1) check(sp == 1 && fabs(pick(1) / (double)(sum / 10000) - 1) < 1e-15, "meanx of a sequence");
+    if (reduction == 2) check(sp == 10000 && same, "eval of a sequence");
+  }
+
+  /* every operation with a constant takes two instructions: the
+     program of x is full after 31 of them */
+  reset();
+  push(1);
+  push(10);
+  range_operation();
+  for (int i = 0; i < 31; i++) {
+    push(1);
+    compute_lazy_operation("+");
+  }
+  check(sp == 1 && is_lazy(pick(1)), "31 operations on a sequence");
+  push(1);
+  compute_lazy_operation("+");
+  check(sp == 2 && last_log_contains("too long"), "too many operations on a sequence");
+  pop();
+  sumx_operation();
+  check(sp == 1 && pick(1) == 55 + 10 * 31, "sumx of a long sequence");
+}
+
+/* Error of a value in units in the last place of the exact result */
+double ulp_error(double value, long double exact) {
+  double rounded = (double)exact;
+  double ulp = nextafter(fabs(rounded), INFINITY) - fabs(rounded);
+
+  if (value == rounded) return 0;
+  return (double)(fabsl(value - exact) / ulp);
+}
+
+/* A random double between a and b, or with a random exponent between
+   a and b when logarithmic is set */
+double random_argument(double a, double b, int logarithmic) {
+  double u = random_uniform(&random_generator);
+
+  if (!logarithmic) return a + (b - a) * u;
+  return ldexp(1 + random_uniform(&random_generator), (int)floor(a + (b - a) * u));
+}
+
+/* The fast functions keep the errors given at the top of dc2_fastmath.c,
+   here over 2 10^5 random arguments each, against the long double libm */
+void test_fast_accuracy(void) {
+  double worst[6] = { 0 };
+
+  random_seed(2);
+  for (int i = 0; i < 200000; i++) {
+    double x = random_argument(-707.7, 709.78, 0);
+    worst[0] = fmax(worst[0], ulp_error(fast_exp(x), expl(x)));
+    x = random_argument(-1022, 1023, 1);
+    worst[1] = fmax(worst[1], ulp_error(fast_log(x), logl(x)));
+    x = random_argument(-1e5, 1e5, 0);
+    worst[2] = fmax(worst[2], ulp_error(fast_sin(x), sinl(x)));
+    worst[3] = fmax(worst[3], ulp_error(fast_cos(x), cosl(x)));
+    worst[4] = fmax(worst[4], ulp_error(fast_tan(x), tanl(x)));
+    x = random_argument(-1022, 1023, 1) * (i % 2 ? 1 : -1);
+    worst[5] = fmax(worst[5], ulp_error(fast_atan(x), atanl(x)));
+  }
+
+  check(worst[0] <= 1, "fast_exp within 1 ulp");
+  check(worst[1] <= 1.5, "fast_log within 1.5 ulp");
+  check(worst[2] <= 2.5, "fast_sin within 2.5 ulp");
+  check(worst[3] <= 2.5, "fast_cos within 2.5 ulp");
+  check(worst[4] <= 4, "fast_tan within 4 ulp");
+  check(worst[5] <= 2.5, "fast_atan within 2.5 ulp");
+}
+
+/* The bulk versions of the fast functions give the values of the
+   scalar ones, bit for bit, with and without arguments needing the
+   libm fallback and on the special values */
+void test_fast_bulk(void) {
+  operation_1o scalar[7] = { fast_exp, fast_log, fast_log10, fast_atan, fast_sin, fast_cos, fast_tan };
+  double v[1003], w[1003];
+
+  random_seed(3);
+  for (int round = 0; round < 2; round++) {
+    for (int i = 0; i < 1000; i++) v[i] = random_argument(-800, 800, 0);
+    v[1000] = round ? INFINITY : 0.0;
+    v[1001] = round ? NAN : -0.0;
+    v[1002] = round ? 1e300 : 5e-324;
+
+    for (int k = 0; k < 7; k++) {
+      int same = 1;
+      memcpy(w, v, sizeof(v));
+      get_bulk_operation_1o(scalar[k])(w, 1003);
+      for (int i = 0; i < 1003; i++) same &= double_to_bits(w[i]) == double_to_bits(scalar[k](v[i]));
+      check(same, "bulk fast function equals the scalar one");
+    }
+  }
+
+  check(isnan(sin_degrees(INFINITY)) && isnan(fast_cos_degrees(-INFINITY)), "degrees of inf");
+  check(isnan(tan_degrees(NAN)), "degrees of nan");
+}
+
+/* A random expression of x, y and z keeping at most depth values,
+   going down to depth values at least once so that the compiled code
+   spills registers around the calls */
+void random_expression(char *text, size_t size, int depth) {
+  char *values[] = { "x", "y", "z", "2", "0.5", "-3" };
+  char *unary[] = { "sin", "cos", "atan", "exp", "ln", "sqrt", "rec", "!" };
+  char *binary[] = { "+", "-", "*", "/", "^" };
+  int n = 0, reached = 0;
+  size_t used = 0;
+
+  /* room for a token and the sums closing the expression */
+  text[0] = '\0';
+  while (used + 8 + 2 * n < size) {
+    uint64_t r = random_next(&random_generator);
+    char *token;
+
+    if (n == depth) reached = 1;
+    if (reached && n == 1 && r % 4 == 0) break;
+    if (n < 1 || (!reached && n < depth && r % 3 != 0)) {
+      token = values[r % 6];
+      n++;
+    } else if (n >= 2 && r % 2 == 0) {
+      token = binary[(r >> 8) % 5];
+      n--;
+    } else {
+      token = unary[(r >> 8) % 8];
+    }
+    used += snprintf(text + used, size - used, "%s%s", used ? " " : "", token);
+  }
+  while (n > 1) {
+    used += snprintf(text + used, size - used, " +");
+    n--;
+  }
+}
+
+/* Compiled expressions give the values of the interpreter, bit for bit
+   (any NaN matching any NaN), in rad and deg mode */
+void test_jit(void) {
+  char text[INPUT_BUFFER];
+  double variables[3];
+  int compiled = 1, same = 1, tested = 0;
+
+  random_seed(4);
+  for (int i = 0; i < 3000; i++) {
+    expr_program program;
+    jit_function f;
+
+    set_mode(i % 2 ? 'd' : 'r');
+    random_expression(text, sizeof(text), 1 + i % JIT_MAX_DEPTH);
+    n_operation_log = 0;
+    if (!parse_expression("test", text, &program)) continue;
+
+    f = get_compiled_expression(&program);
+#if defined(__x86_64__) && (defined(__linux__) || defined(__APPLE__))
+    compiled &= f != NULL;
+#endif
+    if (f == NULL) continue;
+    tested++;
+
+    for (int k = 0; k < 3; k++) {
+      for (int v = 0; v < 3; v++) variables[v] = random_argument(-4, 4, 0);
+      double a = f(variables), b = evaluate_expression(&program, variables);
+      if (!(double_to_bits(a) == double_to_bits(b) || (isnan(a) && isnan(b)))) {
+        if (same) printf("%s: %.17g compiled, %.17g interpreted\n", text, a, b);
+        same = 0;
+      }
+    }
+  }
+  set_mode('r');
+
+  check(compiled && tested > 2500, "random expressions are compiled");
+  check(same, "compiled expressions give the values of the interpreter");
+}
+
+/* --seed gives the same numbers every time, from the single stream
+   and from the bulk lanes, and another seed other numbers */
+void draw_after_seed(char *seed, double *v) {
+  char *argv[] = { "dc2", "--seed", seed, NULL };
+
+  optind = 0;
+  handle_command_line_input(3, argv);
+  reset();
+  push(5);
+  random_numbers_operation();
+  for (int i = 0; i < 5; i++) v[i] = stack[i];
+  v[5] = random_uniform(&random_generator);
+  v[6] = random_normal(&random_generator);
+  v[7] = random_exponential(&random_generator);
+}
+
+void test_random_seed(void) {
+  double a[8], b[8], c[8];
+
+  draw_after_seed("42", a);
+  draw_after_seed("42", b);
+  draw_after_seed("43", c);
+  check(memcmp(a, b, sizeof(a)) == 0, "--seed repeats the numbers");
+  check(a[0] != c[0] && a[5] != c[5], "another --seed gives other numbers");
+
+  reset();
+  push(1e300);
+  random_numbers_operation();
+  check(sp == 1 && pick(1) == 1e300 && last_log_contains("would not fit"), "1e300 rndn");
+  push(NAN);
+  random_numbers_operation();
+  check(sp == 2 && isnan(pick(2)) && last_log_contains("would not fit"), "nan rndn");
+}
+
+/* random_bounded stays in its range, also for ranges near 2^64,
+   and is uniform on small ones: with 70000 draws in [0, 7) every
+   count is within 5 standard deviations of 10000 */
+void test_random_bounded(void) {
+  uint64_t ranges[] = { 1, 2, 3, 7, 1000, 4294967297ULL, 9223372036854775809ULL, UINT64_MAX };
+  long counts[7] = { 0 };
+  int inside = 1, uniform = 1;
+
+  random_seed(5);
+  for (int k = 0; k < 8; k++) {
+    for (int i = 0; i < 10000; i++) inside &= random_bounded(&random_generator, ranges[k]) < ranges[k];
+  }
+  for (int i = 0; i < 70000; i++) counts[random_bounded(&random_generator, 7)]++;
+  for (int i = 0; i < 7; i++) uniform &= labs(counts[i] - 10000) < 5 * 93;
+
+  check(inside, "random_bounded stays in its range");
+  check(uniform, "random_bounded is uniform");
+}
+
+/* Mean and variance of 2 10^5 draws of the ziggurats, within 5
+   standard deviations of those of the distributions: 0 and 1 for the
+   normal one, 1 and 1 for the exponential one */
+void test_random_distributions(void) {
+  const int n = 200000;
+  double sum[2] = { 0 }, squares[2] = { 0 };
+  long tail = 0;
+
+  random_seed(6);
+  for (int i = 0; i < n; i++) {
+    double z = random_normal(&random_generator);
+    double e = random_exponential(&random_generator);
+    sum[0] += z;
+    squares[0] += z * z;
+    sum[1] += e;
+    squares[1] += e * e;
+    tail += fabs(z) > ZIGGURAT_NORMAL_R;
+  }
+
+  double mean = sum[0] / n, variance = squares[0] / n - mean * mean;
+  check(fabs(mean) < 5 / sqrt(n) && fabs(variance - 1) < 5 * sqrt(2.0 / n), "normal mean and variance");
+  /* 2 (1 - Phi(r)) = 5.76e-4 of the draws are in the tails: 115 */
+  check(labs(tail - 115) < 5 * 11, "normal tails");
+
+  mean = sum[1] / n;
+  variance = squares[1] / n - mean * mean;
+  check(fabs(mean - 1) < 5 / sqrt(n) && fabs(variance - 1) < 5 * sqrt(8.0 / n), "exponential mean and variance");
+}
+
+/* The derivative of an expression of x at x, as left in the x
+   register by diff */
+double derivative(char *expression, double x) {
+  reset();
+  push(x);
+  compute_diff(expression);
+  return sp == 2 ? pick(2) : NAN;
+}
+
+/* The second derivative along x, used by minimize */
+double second_derivative(char *expression, double x) {
+  expr_program program;
+  dual r;
+
+  if (!parse_expression("test", expression, &program) || !evaluate_dual(&program, &x, &r)) return NAN;
+  return r.h;
+}
+
+int close_to(double a, double b) {
+  return fabs(a - b) <= 1e-14 * fmax(1, fabs(b));
+}
+
+/* The derivative rules against their closed forms */
+void test_derivatives(void) {
+  const double euler_gamma = 0.57721566490153286;
+
+  check(close_to(derivative("x sqrt", 4), 0.25), "d sqrt");
+  check(close_to(derivative("x ln", 2), 0.5), "d ln");
+  check(close_to(derivative("x log10", 10), 1 / (10 * M_LN10)), "d log10");
+  check(close_to(derivative("x exp", 1), M_E), "d exp");
+  check(close_to(derivative("x rec", 2), -0.25), "d rec");
+  check(close_to(derivative("x !", 1), 1 - euler_gamma), "d !");
+  check(close_to(derivative("x 3 ^", 2), 12), "d x^3");
+  check(close_to(derivative("2 x ^", 3), 8 * M_LN2), "d 2^x");
+  check(close_to(derivative("x x ^", 2), 4 * (M_LN2 + 1)), "d x^x");
+  check(close_to(derivative("x x * x /", 3), 1), "d x x * x /");
+  check(close_to(derivative("x tan", 0.5), 1 / (cos(0.5) * cos(0.5))), "d tan");
+  check(close_to(derivative("x asin", 0.5), 1 / sqrt(0.75)), "d asin");
+  check(close_to(derivative("x acos", 0.5), -1 / sqrt(0.75)), "d acos");
+  check(close_to(derivative("x atan", 1), 0.5), "d atan");
+  set_mode('d');
+  check(close_to(derivative("x sin", 60), 0.5 * M_PI / 180), "d sin in degrees");
+  check(close_to(derivative("x atan", 1), 90 / M_PI), "d atan in degrees");
+  set_mode('r');
+
+  check(close_to(second_derivative("x sin", 1), -sin(1)), "d2 sin");
+  check(close_to(second_derivative("x 3 ^", 2), 12), "d2 x^3");
+  check(close_to(second_derivative("x ln", 2), -0.25), "d2 ln");
+  check(close_to(second_derivative("x !", 1), (1 - euler_gamma) * (1 - euler_gamma) + M_PI * M_PI / 6 - 1),
+        "d2 !");
+
+  /* x and y taken from their registers, df/dx ending in x */
+  reset();
+  push(5);
+  push(3);
+  compute_diff("x y * x +");
+  check(sp == 3 && pick(1) == 18 && pick(2) == 3 && pick(3) == 6, "diff of x and y");
+}
+
+/* solve and minimize converge from a nearby start, and refuse the
+   sequences as all the commands of expressions do */
+void test_solve_minimize(void) {
+  reset();
+  push(1);
+  compute_solve("x x * 2 -");
+  check(sp == 1 && close_to(pick(1), M_SQRT2), "solve x^2 = 2");
+  push(1);
+  compute_solve("x cos x -");
+  check(sp == 2 && close_to(pick(2), 0.73908513321516064), "solve cos x = x");
+  push(0);
+  compute_minimize("x exp x 2 * -");
+  check(sp == 3 && close_to(pick(3), M_LN2), "minimize e^x - 2x");
+  push(0.2);
+  compute_minimize("x x * x ln -");
+  check(sp == 4 && close_to(pick(4), M_SQRT1_2), "minimize x^2 - ln x");
+
+  reset();
+  push(1);
+  push(10);
+  range_operation();
+  compute_solve("x sin");
+  check(sp == 1 && is_lazy(pick(1)) && last_log_contains("eval"), "solve refuses a sequence");
+  compute_diff("x sin");
+  check(sp == 1 && is_lazy(pick(1)) && last_log_contains("eval"), "diff refuses a sequence");
+  push(2);
+  compute_diff("x y *");
+  check(sp == 2 && is_lazy(pick(1)) && last_log_contains("eval"), "diff refuses a sequence in y");
+}
+
+/* All the digits of a big number, in a buffer that the caller frees */
+char *bignum_string(const bignum *a) {
+  char *s = malloc(a->len * BIGNUM_BASE_DIGITS + 2);
+  int n = sprintf(s, "%s%u", a->negative ? "-" : "", a->len ? a->limb[a->len - 1] : 0);
+  for (size_t i = a->len > 0 ? a->len - 1 : 0; i > 0; i--) n += sprintf(s + n, "%09u", a->limb[i - 1]);
+  return s;
+}
+
+/* Compare the last exact result with its length, the sum of its
+   digits and the digits at both ends */
+int last_exact_is(size_t length, long digit_sum, char *head, char *tail) {
+  char *s = bignum_string(&last_exact);
+  size_t n = strlen(s);
+  long sum = 0;
+  for (size_t i = 0; i < n; i++) sum += s[i] - '0';
+  int same = n == length && sum == digit_sum && strncmp(s, head, strlen(head)) == 0 &&
+             strcmp(s + n - strlen(tail), tail) == 0;
+  free(s);
+  return same;
+}
+
+void test_exact(void) {
+  char *s;
+
+  exact_factorial(100);
+  s = bignum_string(&last_exact);
+  check(strcmp(s, "93326215443944152681699238856266700490715968264381621468592963895217599993229915608941463976156518286253697920827223758251185210916864000000000000000000000000") == 0, "100!");
+  free(s);
+
+  exact_to_power(1000, 2);
+  s = bignum_string(&last_exact);
+  check(strcmp(s, "10715086071862673209484250490600018105614048117055336074437503883703510511249361224931983788156958581275946729175531468251871452856923140435984577574698574803934567774824230985421074605062371141877954182153046474983581941267398767559165543946077062914571196477686542167660429831652624386837205668069376") == 0, "2^1000");
+  free(s);
+
+  exact_to_power(3, -7);
+  s = bignum_string(&last_exact);
+  check(strcmp(s, "-343") == 0, "(-7)^3");
+  free(s);
+
+  /* the last products of these are well above KARATSUBA_THRESHOLD limbs */
+  exact_factorial(1000);
+  check(last_exact_is(2568, 10539, "402387260077093773543702433923", "000000000000000000000000000000"), "1000!");
+  exact_to_power(5000, 3);
+  check(last_exact_is(2386, 11097, "403899762978715533970086340981", "732633600493563136998276100001"), "3^5000");
+
+  /* Karatsuba against the quadratic algorithm, balanced and not */
+  size_t sizes[][2] = { { 48, 48 }, { 200, 200 }, { 301, 157 }, { 1000, 97 } };
+  for (int k = 0; k < 4; k++) {
+    size_t na = sizes[k][0], nb = sizes[k][1];
+    uint32_t *a = limbs_alloc(na), *b = limbs_alloc(nb);
+    uint32_t *fast = limbs_alloc(na + nb), *slow = limbs_alloc(na + nb);
+    for (size_t i = 0; i < na; i++) a[i] = (uint32_t)(random_next(&random_generator) % BIGNUM_BASE);
+    for (size_t i = 0; i < nb; i++) b[i] = k == 0 ? BIGNUM_BASE - 1 : (uint32_t)(random_next(&random_generator) % BIGNUM_BASE);
+    limbs_mul(fast, a, na, b, nb);
+    limbs_mul_schoolbook(slow, a, na, b, nb);
+    check(memcmp(fast, slow, (na + nb) * sizeof(uint32_t)) == 0, "karatsuba matches schoolbook");
+    free(a);
+    free(b);
+    free(fast);
+    free(slow);
+  }
+}
+
+/* The order sort promises: NaNs with the sign bit first, then -inf,
+   the numbers with -0 before 0, inf and the other NaNs last */
+int order_class(double x) {
+  return isnan(x) ? (signbit(x) ? 0 : 2) : 1;
+}
+
+int compare_for_sort(const void *p, const void *q) {
+  double a = *(const double *)p, b = *(const double *)q;
+  if (order_class(a) != order_class(b)) return order_class(a) - order_class(b);
+  if (isnan(a)) return 0;
+  if (a != b) return a < b ? -1 : 1;
+  return (int)!signbit(a) - (int)!signbit(b);
+}
+
+/* Fill the stack with n values full of special cases and duplicates,
+   keeping a copy sorted by the reference order */
+void fill_stack_for_sort(long n, double *sorted) {
+  double special[] = { -0.0, 0.0, INFINITY, -INFINITY, NAN, -NAN, 4.9e-324, -4.9e-324, 1, -1 };
+  reset();
+  for (long i = 0; i < n; i++) {
+    uint64_t r = random_next(&random_generator);
+    double x;
+    if (r % 4 == 0) x = special[(r >> 8) % 10];
+    else if (r % 4 == 1) x = (double)((int)((r >> 8) % 21) - 10);
+    else x = bits_to_double(r >> 8 << 8);
+    push(x);
+  }
+  memcpy(sorted, stack, n * sizeof(double));
+  qsort(sorted, n, sizeof(double), compare_for_sort);
+}
+
+/* The value at rank h of a sorted array, as nth, median and
+   percentile interpolate it */
+double order_statistic(double *sorted, long n, double h) {
+  long j = (long)floor(h);
+  if (h == j || j + 1 >= n) return sorted[j];
+  return sorted[j] + (h - j) * (sorted[j + 1] - sorted[j]);
+}
+
+int same_value(double a, double b) {
+  return double_to_bits(a) == double_to_bits(b) || (isnan(a) && isnan(b) && signbit(a) == signbit(b));
+}
+
+void test_sort(void) {
+  static double sorted[5000];
+  long sizes[] = { 2, 10, INSERTION_SORT_MAX, INSERTION_SORT_MAX + 1, 1000, 5000 };
+
+  for (int s = 0; s < 6; s++) {
+    long n = sizes[s];
+    int same = 1;
+
+    fill_stack_for_sort(n, sorted);
+    sort_operation();
+    for (long i = 0; i < n; i++) same &= same_value(stack[i], sorted[i]);
+    check(sp == n && same, "sort");
+
+    fill_stack_for_sort(n, sorted);
+    rsort_operation();
+    same = 1;
+    for (long i = 0; i < n; i++) same &= same_value(stack[i], sorted[n - 1 - i]);
+    check(sp == n && same, "rsort");
+  }
+
+  /* the order statistics of numbers only, where interpolating makes sense */
+  for (int s = 0; s < 6; s++) {
+    long n = sizes[s];
+    for (long k = 0; k < 3; k++) {
+      fill_stack_for_sort(n, sorted);
+      for (long i = 0; i < n; i++) if (!isfinite(stack[i])) stack[i] = (double)(i % 7);
+      memcpy(sorted, stack, n * sizeof(double));
+      qsort(sorted, n, sizeof(double), compare_for_sort);
+
+      long rank = 1 + (long)(random_next(&random_generator) % n);
+      double p = (double)(random_next(&random_generator) % 1001) / 10;
+      if (k == 0) {
+        median_operation();
+        check(sp == 1 && same_value(pick(1), order_statistic(sorted, n, (n - 1) / 2.0)), "median");
+      } else if (k == 1) {
+        push(rank);
+        nth_operation();
+        check(sp == 1 && same_value(pick(1), sorted[rank - 1]), "nth");
+      } else {
+        push(p);
+        percentile_operation();
+        check(sp == 1 && same_value(pick(1), order_statistic(sorted, n, (n - 1) * p / 100)), "percentile");
+      }
+    }
+  }
+
+  reset();
+  double values[] = { -0.0, 0.0, 0.0, 1, 1, 1, NAN, NAN, 2 };
+  for (int i = 0; i < 9; i++) push(values[i]);
+  uniq_operation();
+  check(sp == 5 && signbit(stack[0]) && !signbit(stack[1]) && stack[2] == 1 && isnan(stack[3]) &&
+        stack[4] == 2 && last_log_contains("removed 4"), "uniq");
+  /* only adjacent repetitions go */
+  push(1);
+  push(2);
+  uniq_operation();
+  check(sp == 7, "uniq keeps values that are not adjacent");
+
+  for (long n = 1; n <= 300; n += 37) {
+    int same_sum = 1, same_product = 1;
+    double sum = 0, product = 1;
+    double factors[] = { 2, 0.5, -1, 1, 4 };
+
+    reset();
+    for (long i = 0; i < n; i++) push((double)(i % 13) - 6);
+    cumsum_operation();
+    for (long i = 0; i < n; i++) {
+      sum += (double)(i % 13) - 6;
+      same_sum &= stack[i] == sum;
+    }
+    check(sp == n && same_sum, "cumsum");
+
+    reset();
+    for (long i = 0; i < n; i++) push(factors[i % 5]);
+    cumprod_operation();
+    for (long i = 0; i < n; i++) {
+      product *= factors[i % 5];
+      same_product &= stack[i] == product;
+    }
+    check(sp == n && same_product, "cumprod");
+  }
+
+  reset();
+  push(1);
+  push(1);
+  push(10);
+  range_operation();
+  uniq_operation();
+  check(sp == 2 && is_lazy(pick(2)) && last_log_contains("eval"), "uniq refuses a sequence");
+}
+
+/* fft agrees with the definition of the transform and ifft brings the
+   signal back, for powers of two and for lengths that go through
+   Bluestein's algorithm */
+void test_fft(void) {
+  long lengths[] = { 1, 2, 8, 1024, 3, 7, 100, 1000, 1023 };
+  static double signal[1024];
+
+  for (int l = 0; l < 9; l++) {
+    long n = lengths[l];
+    double largest = 0, error = 0, round_trip = 0;
+
+    reset();
+    for (long i = 0; i < n; i++) {
+      signal[i] = (double)(random_next(&random_generator) >> 11) * 0x1p-53 * 2 - 1;
+      push(signal[i]);
+    }
+    push(n);
+    fft_operation();
+    check(sp == 2 * n && last_log_contains("fft of"), "fft length");
+
+    /* the definition, only where it stays fast */
+    for (long k = 0; k < n && n <= 100; k++) {
+      double re = 0, im = 0;
+      for (long i = 0; i < n; i++) {
+        re += signal[i] * cos(2 * M_PI * (double)(i * k % n) / n);
+        im -= signal[i] * sin(2 * M_PI * (double)(i * k % n) / n);
+      }
+      error = fmax(error, fmax(fabs(stack[2 * k] - re), fabs(stack[2 * k + 1] - im)));
+    }
+    check(error < 1e-13 * n, "fft against the definition");
+
+    push(n);
+    ifft_operation();
+    for (long i = 0; i < n && sp == n; i++) {
+      round_trip = fmax(round_trip, fabs(stack[i] - signal[i]));
+      largest = fmax(largest, fabs(signal[i]));
+    }
+    check(sp == n && round_trip <= 1e-14 * log2(2 * n) * largest, "ifft of fft");
+  }
+}
+
+/* conv gives the same values directly and through the transforms:
+   the pairs of lengths fall on both sides of CONV_DIRECT_RATIO */
+void test_conv(void) {
+  long lengths[][2] = { { 30, 30 }, { 190, 190 }, { 200, 200 }, { 1000, 3 }, { 1000, 1000 }, { 5, 2000 } };
+  static double a[2000], b[2000], expected[4000];
+  int direct_cases = 0;
+
+  for (int l = 0; l < 6; l++) {
+    long m = lengths[l][0], n = lengths[l][1];
+    long size = next_power_of_two(m + n - 1);
+    int direct = (double)m * n <= CONV_DIRECT_RATIO * size * log2(size);
+    double error = 0;
+
+    direct_cases += direct;
+
+    /* small integers, so that the direct sums are exact */
+    reset();
+    for (long i = 0; i < m; i++) push(a[i] = (double)(random_next(&random_generator) % 201) - 100);
+    for (long j = 0; j < n; j++) push(b[j] = (double)(random_next(&random_generator) % 201) - 100);
+    for (long k = 0; k < m + n - 1; k++) expected[k] = 0;
+    for (long i = 0; i < m; i++) {
+      for (long j = 0; j < n; j++) expected[i + j] += a[i] * b[j];
+    }
+
+    push(m);
+    push(n);
+    conv_operation();
+    for (long k = 0; k < m + n - 1 && sp == m + n - 1; k++) error = fmax(error, fabs(stack[k] - expected[k]));
+    check(sp == m + n - 1 && error <= (direct ? 0 : 1e-6), "conv");
+  }
+  check(direct_cases == 4, "conv lengths on both sides of CONV_DIRECT_RATIO");
+}
+
+/* Fill the stack with n values, special ones included, that a save
+   must write and a load read back unchanged (NaNs without payload) */
+void fill_stack_for_save(long n, double *values) {
+  double special[] = { -0.0, INFINITY, -INFINITY, NAN, -NAN, 4.9e-324, DBL_MAX, 0.1 };
+  reset();
+  for (long i = 0; i < n; i++) {
+    uint64_t r = random_next(&random_generator);
+    double x = bits_to_double(r);
+    if (i < 8) x = special[i];
+    else if (isnan(x)) x = (double)i;
+    push(values[i] = x);
+  }
+}
+
+/* save and load give back the same stack in both formats, across
+   the writes of IO_BUFFER_SIZE bytes */
+void test_save_load(void) {
+  static double values[300000];
+  char path[64];
+  char *extensions[] = { ".bin", ".txt", ".csv" };
+  long lengths[] = { 300000, 100000, 1000 };
+
+  for (int f = 0; f < 3; f++) {
+    long n = lengths[f];
+    int same = 1;
+
+    snprintf(path, sizeof(path), "/tmp/dc2_test_%d%s", (int)getpid(), extensions[f]);
+    fill_stack_for_save(n, values);
+    check(compute_save(path), "save");
+    reset();
+    compute_load(path);
+    for (long i = 0; i < n && sp == n; i++) same &= same_value(stack[i], values[i]);
+    check(sp == n && same && last_log_contains("values"), "load what was saved");
+    unlink(path);
+  }
+
+  /* fields that are not numbers are skipped */
+  snprintf(path, sizeof(path), "/tmp/dc2_test_%d.csv", (int)getpid());
+  FILE *file = fopen(path, "w");
+  fprintf(file, "time,value\n1,-2.5\n2,1e3\n");
+  fclose(file);
+  reset();
+  compute_load(path);
+  check(sp == 4 && stack[1] == -2.5 && stack[3] == 1000 && n_operation_log == 2 &&
+        strstr(operation_log[0], "skipped 2 fields") != NULL, "load a CSV file with a header");
+  unlink(path);
+
+  snprintf(path, sizeof(path), "/tmp/dc2_test_%d.bin", (int)getpid());
+  file = fopen(path, "w");
+  fprintf(file, "12345");
+  fclose(file);
+  reset();
+  compute_load(path);
+  check(sp == 0 && last_log_contains("multiple of 8"), "load a truncated binary file");
+  unlink(path);
+
+  reset();
+  compute_load("/nonexistent/dc2_test.bin");
+  check(sp == 0 && last_log_contains("No such file"), "load a missing file");
+
+  reset();
+  push(1);
+  push(10);
+  range_operation();
+  check(!compute_save(path) && last_log_contains("eval") && access(path, F_OK) != 0, "save refuses a sequence");
+}
+
+int main(void) {
+  test_wilkinson_roots();
+  test_clustered_roots();
+  test_random_roots();
+  test_dd_limits();
+  test_polygamma();
+  test_lazy_sequences();
+  test_fast_accuracy();
+  test_fast_bulk();
+  test_jit();
+  test_random_seed();
+  test_random_bounded();
+  test_random_distributions();
+  test_derivatives();
+  test_solve_minimize();
+  test_exact();
+  test_sort();
+  test_fft();
+  test_conv();
+  test_save_load();
+
+  if (failures == 0) printf("All tests passed\n");
+  return failures != 0;
+}
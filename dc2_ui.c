@@ -25,12 +25,20 @@ void locate(int x, int y) {
     printf("\033[%d;%dH", y, x);
 }
 
+/* Width of the register column, enough for the deepest position */
+int register_width(void) {
+  int width = 2;
+  for (int n = sp; n >= 100; n /= 10) width++;
+  return width;
+}
+
 /* Returns the register name to be displayed for a stack position */
-void get_register_name(int i, char* buffer) {
-  sprintf(buffer, "%2d", i);
+void get_register_name(int i, char* buffer, size_t size) {
+  int width = register_width();
+  snprintf(buffer, size, "%*d", width, i);
 
-  if (i==1) strcpy(buffer," x");
-  if (i==2) strcpy(buffer," y");
+  if (i==1) snprintf(buffer, size, "%*s", width, "x");
+  if (i==2) snprintf(buffer, size, "%*s", width, "y");
 }
 
 /* Display the command line help when called with the --help parameter */
@@ -43,6 +51,13 @@ void show_command_line_help(void) {
     printf("  -r, --rad          Set angle mode to radians (default)\n");
     printf("  -s, --sci          Use scientific notation for numbers (default)\n");
     printf("  -f, --fix          Use fixed-point notation for numbers\n");
+    printf("  -x, --exact        Compute factorials and integer powers exactly\n");
+    printf("  -D, --dd           Compute in double-double precision (31 digits)\n");
+    printf("  -p, --precision P  Use fast polynomial or accurate libm functions\n");
+    printf("                     (P = fast or accurate, default accurate)\n");
+    printf("  -S, --seed N       Seed the random number generator\n");
+    printf("  -l, --load FILE    Push the values of FILE on the stack\n");
+    printf("  -o, --save FILE    Write the stack to FILE when quitting\n");
     printf("  -V, --version      Show version information and exit\n");
     printf("  -h, --help         Display this help message and exit\n\n");
 
@@ -73,6 +88,13 @@ void show_license_message(void) {
 }
 
 void print_number(char* buffer, double number) {
+  if (is_lazy(number)) {
+    char text[32];
+    describe_lazy(number, text, sizeof(text));
+    printf("│ %s │ %25s│\n", buffer, text);
+    return;
+  }
+
   double abs_number = number < 0 ? number * -1 : number; 
   if ((abs_number >= 1e10) || (abs_number > 0 && abs_number < 1e-6)) {
     printf("│ %s │ %25.15e│\n", buffer, number);
@@ -86,12 +108,22 @@ void print_number(char* buffer, double number) {
   }
 }
 
+/* Print a double-double number with all its significant digits */
+void print_dd_number(char* buffer, dd number) {
+  char digits[64];
+  if (is_lazy(number.hi)) describe_lazy(number.hi, digits, sizeof(digits));
+  else dd_to_string(digits, number, DD_DIGITS);
+  printf("│ %s │ %38s│\n", buffer, digits);
+}
+
 /* Show history */
 void show_history(void) {
   int k = 0;
-  locate (40, 5);
+  // the double-double stack is wider, move the history on its right
+  int column = ((arithmetic_mode == 'd') ? 53 : 40) + register_width() - 2;
+  locate (column, 5);
   printf("HISTORY\n");  
-  locate (40, 6);
+  locate (column, 6);
   printf("───────\n");  
 
   int begin = (n_operation_log - HISTORY_MAX_VIEWABLE_ELEMENTS - view_offset) > 0 ? n_operation_log - HISTORY_MAX_VIEWABLE_ELEMENTS - view_offset: 0;
@@ -103,22 +135,34 @@ void show_history(void) {
 //  printf("%d %d %d %d", n_operation_log, begin, end, view_offset);
 
   if (begin > 0) {
-    locate (39, 7);
+    locate (column - 1, 7);
     printf("⇡");    
   }
 
   // Display the history
   for (int i = begin; i < end; i++) {
-    locate (40, (7 + (k++)));
+    locate (column, (7 + (k++)));
     printf("%s", operation_log[i]);
   }
 
   if (end < n_operation_log) {
-    locate (39, (7 + k - 1));
+    locate (column - 1, (7 + k - 1));
     printf("⇣");    
   } 
 }
 
+/* Print a line of the stack box, as wide as the registers and
+   the values (the double-double ones are wider) */
+void print_stack_border(char* left, char* middle, char* right, char* fill) {
+  int value_width = (arithmetic_mode == 'd') ? 39 : 26;
+
+  printf("%s", left);
+  for (int i = 0; i < register_width() + 2; i++) printf("%s", fill);
+  printf("%s", middle);
+  for (int i = 0; i < value_width; i++) printf("%s", fill);
+  printf("%s\n", right);
+}
+
 /* Shows the status of the calculator  */
 void view_status(void) {
   printf("\x1B[1;1H\x1B[2J");
@@ -131,28 +175,35 @@ void view_status(void) {
   if (numeric_format == 'f') strcpy(numeric_format_string, "fix");
   if (numeric_format == 's') strcpy(numeric_format_string, "sci");
 
-  printf("┌─────┬─────┐ \n");	
-  printf("│ %s │ %s │ \n", mode_string, numeric_format_string);
-  printf("└─────┴─────┘ \n");	
+  char arithmetic_mode_string[] = "err";
+  if (arithmetic_mode == 'f') strcpy(arithmetic_mode_string, "flt");
+  if (arithmetic_mode == 'x') strcpy(arithmetic_mode_string, "exa");
+  if (arithmetic_mode == 'd') strcpy(arithmetic_mode_string, "dd ");
+
+  printf("┌─────┬─────┬─────┐ \n");	
+  printf("│ %s │ %s │ %s │ \n", mode_string, numeric_format_string, arithmetic_mode_string);
+  printf("└─────┴─────┴─────┘ \n");	
 
   printf("                 STACK\n");
-  printf("┌────┬──────────────────────────┐\n");
+  print_stack_border("┌", "┬", "┐", "─");
 
-  char buffer[3];
+  char buffer[12];
 
   int start = 0;
   if (sp > MAX_VIEWABLE_STACK) {
     start = sp - (MAX_VIEWABLE_STACK - 1);
-    get_register_name((sp) , buffer);
-    print_number(buffer, stack[sp - 1]);
-    printf("│....│..........................│\n");
+    get_register_name((sp) , buffer, sizeof(buffer));
+    if (arithmetic_mode == 'd') print_dd_number(buffer, pick_dd(sp));
+    else print_number(buffer, stack[sp - 1]);
+    print_stack_border("│", "│", "│", ".");
   }
 
   for (int i=start; i<sp; i++) {
-    get_register_name((sp) - i, buffer);
-    print_number(buffer, stack[i]);
+    get_register_name((sp) - i, buffer, sizeof(buffer));
+    if (arithmetic_mode == 'd') print_dd_number(buffer, pick_dd(i + 1));
+    else print_number(buffer, stack[i]);
   } 
-  printf("└────┴──────────────────────────┘\n");
+  print_stack_border("└", "┴", "┘", "─");
 
   show_history();
   
@@ -187,13 +238,24 @@ void show_help(void) {
     printf("HELP - Dave's (RPN) Calculator\n");
     printf("------------------------------\n");
     printf("Numbers & Ops:    <num>  +  -  *  /  ^\n");
-    printf("Modes:            fix  sci   deg  rad\n");
+    printf("Modes:            fix  sci   deg  rad   exact  float  dd\n");
+    printf("                  fast  accurate\n");
     printf("Stack Ops:        d(drop)  s(swap)  c(clear)\n");
     printf("                  roll  unroll  [arrows]\n");
     printf("Consts & Rand:    pi   e   rnd/random\n");
-    printf("Functions:        sqrt  log  ln  log10  !  rec(/)\n");
-    printf("Trig:             sin cos tan  asin acos atan\n");
+    printf("                  rndn  rndnorm  rndexp  rndint\n");
+    printf("Whole Stack:      sort rsort uniq  median nth percentile\n");
+    printf("                  cumsum  cumprod  map <expr in x>\n");
+    printf("Signals:          fft  ifft  psd  conv\n");
+    printf("Polynomials:      poly  polymap  polyroots  polyfit\n");
+    printf("Sequences:        range linspace geom rndseq  eval\n");
+    printf("                  sumx prodx meanx minx maxx\n");
+    printf("Files:            load <file>  save <file>\n");
+    printf("Functions:        sqrt  log  ln  log10  exp  !  rec(/)\n");
+    printf("Trig:             sin cos tan  asin acos atan  sincos\n");
     printf("Other Cmds:       ENTER = repeat\n");
+    printf("                  digits (of last exact result)\n");
+    printf("Calculus:         diff/solve/minimize <expr in x y z>\n");
     printf("                  h/help  ?/credits  q/quit\n");
     printf("------------------------------\n");
     printf("Made with ❤ in Italy   (v%s)\n", APP_VERSION);
@@ -211,6 +273,8 @@ void show_extended_help(void) {
     printf("  ^                            Power (y^x)\n");
     printf("  fix / sci                    Set numeric display format\n");
     printf("  deg / rad                    Set angle mode\n");
+    printf("  exact / float / dd           Set arithmetic mode\n");
+    printf("  fast / accurate              Set math functions precision\n");
     printf("\n");
     printf("Stack Operations:\n");
     printf("  d / drop                     Remove top of stack (x) \n");
@@ -218,10 +282,19 @@ void show_extended_help(void) {
     printf("  c / clear                    Clear stack\n");
     printf("  roll / unroll / arrows keys  Rotate stack (right / left)\n");
     printf("\n");
-    printf("Constants and Random:\n");
+    printf("Constants:\n");
     printf("  pi                           Push π\n");
     printf("  e                            Push Euler's number\n");
-    printf("  rnd / random                 Push random number [0,1)\n");
+    printf("\n");
+    printf("Polynomials (degree n in x, n + 1 coefficients below):\n");
+    printf("  poly                         Value of the polynomial at y\n");
+    printf("  polymap                      Polynomial of every other value\n");
+    printf("  polyroots                    n roots as re, im pairs\n");
+    printf("  polyfit                      Least squares fit of x y pairs\n");
+    printf("\n");
+    printf("Files (.bin/.f64/.raw binary float64, .csv, else text):\n");
+    printf("  load <file>                  Push the values of a file\n");
+    printf("  save <file>                  Write the stack, x last\n");
     printf("\n");
     printf("Press ENTER for more...");
     getchar();
@@ -229,19 +302,58 @@ void show_extended_help(void) {
     printf("\x1B[1;1H\x1B[2J"); // Clear screen
     printf("HELP (page 2) - Dave's (RPN) Calculator\n");
     printf("---------------------------------------\n");
+    printf("Random:\n");
+    printf("  rnd / random                 Push random number [0,1)\n");
+    printf("  rndn                         Replace x with x random numbers\n");
+    printf("  rndnorm / rndexp             Push normal / exponential number\n");
+    printf("  rndint                       Random integer in [y, x]\n");
+    printf("\n");
+    printf("Whole Stack:\n");
+    printf("  sort / rsort                 Sort (largest in x / smallest in x)\n");
+    printf("  uniq                         Remove repeated adjacent values\n");
+    printf("  median                       Replace stack with its median\n");
+    printf("  nth                          Replace stack with x-th smallest\n");
+    printf("  percentile                   Replace stack with x-th percentile\n");
+    printf("  cumsum / cumprod             Running sums / products\n");
+    printf("  map <expr>                   Replace every value with expr(x)\n");
+    printf("\n");
+    printf("Sequences (computed only when reduced or evaluated):\n");
+    printf("  range / linspace / geom      y..x  /  z to y in x  /  z*y^k, x values\n");
+    printf("  rndseq                       x random numbers [0,1)\n");
+    printf("  sumx prodx meanx minx maxx   Reduce x;   eval  push its values\n");
+    printf("\n");
+    printf("Signals (length in x, complex values as re, im pairs):\n");
+    printf("  fft / ifft                   Fourier transform / inverse\n");
+    printf("  psd                          Power spectral density\n");
+    printf("  conv                         Convolve signals of lengths y, x\n");
+    printf("\n");
+    printf("Press ENTER for more...");
+    getchar();
+
+    printf("\x1B[1;1H\x1B[2J"); // Clear screen
+    printf("HELP (page 3) - Dave's (RPN) Calculator\n");
+    printf("---------------------------------------\n");
     printf("Functions:\n");
     printf("  sqrt                         Square root\n");
     printf("  log / ln                     Natural logarithm\n");
     printf("  log10                        Log base 10\n");
+    printf("  exp                          Exponential\n");
     printf("  !                            Factorial (n!)\n");
     printf("  rec or \\                     Reciprocal (1/x)\n");
     printf("\n");
     printf("Trigonometry:\n");
     printf("  sin  cos  tan                Basic trig functions\n");
     printf("  asin acos atan               Inverse trig functions\n");
+    printf("  sincos                       Replace x with sin(x) and cos(x)\n");
+    printf("\n");
+    printf("Calculus (expressions in x, y, z taken from the stack):\n");
+    printf("  diff <expr>                  Value and partial derivatives\n");
+    printf("  solve <expr>                 Root of expr(x) near x\n");
+    printf("  minimize <expr>              Minimum of expr(x) near x\n");
     printf("\n");
     printf("Other Commands:\n");
     printf("  ENTER                        Repeat last input\n");
+    printf("  digits                       Show the last exact result\n");
     printf("  h / help                     Show this help\n");
     printf("  ? / credits                  About the author\n");
     printf("  q / quit                     Exit calculator\n");